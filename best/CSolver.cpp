@@ -0,0 +1,320 @@
+#include "CSolver.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <omp.h>
+
+CSolver::CSolver(const int n, const int a, const vector<vector<int> > &graph, const CSparseGraph &sparse,
+                 const int memory_mb)
+    : n(n), a(a), graph(graph), sparse(sparse), use_sparse(sparse.density < SPARSE_DENSITY),
+      min_cut_weight(numeric_limits<int>::max()), n_rec(0), open(n + 1), open_size(0),
+      max_open(static_cast<long long>(memory_mb) * 1024 * 1024 /
+               static_cast<long long>(sizeof(CState) + n * sizeof(int))),
+      peak_open(0), fallbacks(0), busy(0) {
+}
+
+void CSolver::deltas(const int node, const vector<int> &partition, int &delta_x, int &delta_y) const {
+    delta_x = delta_y = 0; // Contribution to cut weight when assigning node to X or Y
+    if (use_sparse) {
+        // Neighbour lists are sorted, so only the neighbours already assigned are visited
+        const int *neighbours = sparse.neighbours.data(), *weights = sparse.weights.data();
+        for (int e = sparse.offsets[node]; e < sparse.offsets[node + 1] && neighbours[e] < node; e++) {
+            if (partition[neighbours[e]] == 0)
+                delta_x += weights[e]; // Adding edges between node and subset X
+            else
+                delta_y += weights[e]; // Adding edges between node and subset Y
+        }
+    } else {
+        for (int i = 0; i < node; i++) {
+            if (partition[i] == 0)
+                delta_x += graph[i][node]; // Adding edges between node and subset X
+            else
+                delta_y += graph[i][node]; // Adding edges between node and subset Y
+        }
+    }
+}
+
+int CSolver::low_bound(const int node, const vector<int> &partition) const {
+    int low_bound_x = 0, low_bound_y = 0, low_bound = 0; // Lower bound for the future cut weight
+    if (use_sparse) {
+        const int *neighbours = sparse.neighbours.data(), *weights = sparse.weights.data();
+        for (int i = node; i < n; i++) {
+            for (int e = sparse.offsets[i]; e < sparse.offsets[i + 1] && neighbours[e] < node; e++) {
+                if (partition[neighbours[e]] == 0)
+                    low_bound_x += weights[e];
+                else
+                    low_bound_y += weights[e];
+            }
+            low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+            low_bound_x = 0, low_bound_y = 0;
+        }
+    } else {
+        for (int i = node; i < n; i++) {
+            for (int j = 0; j < node; j++) {
+                if (partition[j] == 0)
+                    low_bound_x += graph[j][i];
+                else
+                    low_bound_y += graph[j][i];
+            }
+            low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+            low_bound_x = 0, low_bound_y = 0;
+        }
+    }
+    return low_bound;
+}
+
+void CSolver::dfs(const int node, const int x_count, const int cut_weight, vector<int> &partition) {
+    #pragma omp atomic update
+    n_rec++; // Atomically increment the node counter
+
+    // Prune the search if the current cut weight exceeds the best found so far, less the allowed gap
+    const int limit = gap.limit(min_cut_weight);
+    if (cut_weight > limit)
+        return;
+
+    // If all nodes are processed, check if a valid partition is found
+    if (node == n) {
+        if (x_count == a) // Ensure the subset X has exactly 'a' elements
+            record_partition(cut_weight, partition);
+        return;
+    }
+
+    int delta_x, delta_y;
+    deltas(node, partition, delta_x, delta_y);
+
+    // Stop if the minimum possible future cut weight is already worse than the best found
+    if (low_bound(node, partition) + cut_weight > limit) {
+        return;
+    }
+
+    // Small subtrees are enumerated at once instead of recursing node by node
+    if (n - node <= TAIL_SIZE) {
+        tail(node, x_count, cut_weight, partition);
+        return;
+    }
+
+    // Try adding the node to subset X if it doesn't exceed the allowed size
+    if (x_count < a) {
+        partition[node] = 0;
+        dfs(node + 1, x_count + 1, cut_weight + delta_y, partition);
+    }
+
+    partition[node] = 1; // Assign the node to subset Y and continue the search
+    dfs(node + 1, x_count, cut_weight + delta_x, partition);
+}
+
+void CSolver::tail(const int node, const int x_count, const int cut_weight, vector<int> &partition) {
+    const int remaining = n - node, x_left = a - x_count;
+    if (x_left < 0 || x_left > remaining)
+        return;
+
+    // Cost of each unassigned node towards the assigned ones, and the weights among the unassigned nodes
+    int cost_x[TAIL_LANES], cost_y[TAIL_LANES], degree[TAIL_LANES];
+    CTailVector rows[TAIL_LANES] = {};
+    int total = cut_weight; // Cut weight of the current mask, which starts with every unassigned node in Y
+    for (int u = 0; u < remaining; u++) {
+        cost_x[u] = cost_y[u] = degree[u] = 0;
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0)
+                cost_y[u] += graph[j][node + u]; // Cut when u goes to Y
+            else
+                cost_x[u] += graph[j][node + u]; // Cut when u goes to X
+        }
+        for (int v = 0; v < remaining; v++) {
+            if (v == u) continue;
+            rows[u][v] = graph[node + u][node + v];
+            degree[u] += rows[u][v];
+        }
+        total += cost_y[u];
+    }
+
+    // Walk all subsets in Gray code order, each step moves one node and updates every lane at once
+    CTailVector in_x = {}; // Weight from each unassigned node to the unassigned nodes in X
+    int mask = 0, count = 0;
+    for (int step = 0; step < 1 << remaining; step++) {
+        if (step > 0) {
+            const int u = __builtin_ctz(step);
+            mask ^= 1 << u;
+            if ((mask >> u) & 1) {
+                total += cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                in_x += rows[u];
+                count++;
+            } else {
+                in_x -= rows[u];
+                total -= cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                count--;
+            }
+        }
+        if (count == x_left && total <= min_cut_weight) {
+            for (int u = 0; u < remaining; u++) partition[node + u] = (mask >> u) & 1 ? 0 : 1;
+            record_partition(total, partition);
+        }
+    }
+}
+
+void CSolver::record_partition(const int cut_weight, const vector<int> &partition) {
+    #pragma omp critical
+    {
+        if (cut_weight == min_cut_weight) {
+            best_partitions.push_back(partition); // Store another optimal partition
+        } else if (cut_weight < min_cut_weight) {
+            min_cut_weight = cut_weight; // Update the best cut weight found
+            best_partitions.clear(); // Clear previous partitions
+            best_partitions.push_back(partition); // Store the new best partition
+        }
+    }
+}
+
+void CSolver::dive() {
+    // Greedy path to a leaf, each node goes to the side it has more weight towards
+    vector<int> partition(n, -1);
+    int node = 0, x_count = 0, cut_weight = 0;
+    if (2 * a == n) {
+        partition[0] = 0;
+        node = x_count = 1;
+    }
+    for (; node < n; node++) {
+        int delta_x, delta_y;
+        deltas(node, partition, delta_x, delta_y);
+        const bool can_x = x_count < a, can_y = n - node - 1 >= a - x_count;
+        const bool to_x = can_x && (!can_y || delta_y <= delta_x);
+        partition[node] = to_x ? 0 : 1;
+        cut_weight += to_x ? delta_y : delta_x;
+        x_count += to_x ? 1 : 0;
+    }
+    record_partition(cut_weight, partition);
+}
+
+bool CSolver::pop(CState &state, bool &depth_first) {
+    unique_lock<mutex> lock(open_mutex);
+    while (true) {
+        if (open_size == 0) {
+            if (busy == 0) {
+                open_ready.notify_all(); // Nothing left and nobody can add more
+                return false;
+            }
+            open_ready.wait(lock);
+            continue;
+        }
+
+        // Over the memory cap the deepest state is searched depth-first, which adds nothing to the queue
+        depth_first = open_size > max_open;
+        int depth = -1;
+        for (int d = n; d >= 0; d--) {
+            if (open[d].empty()) continue;
+            if (depth_first) {
+                depth = d;
+                break;
+            }
+            if (depth == -1 || open[d].front().bound < open[depth].front().bound) depth = d; // Deeper wins ties
+        }
+
+        // The lowest bound is already worse than the best cut less the gap, so are all other open states
+        if (!depth_first && open[depth].front().bound > gap.limit(min_cut_weight)) {
+            for (auto &heap: open) heap.clear();
+            open_size = 0;
+            continue;
+        }
+
+        pop_heap(open[depth].begin(), open[depth].end(), CWorseBound());
+        state = move(open[depth].back());
+        open[depth].pop_back();
+        open_size--;
+        busy++;
+        if (depth_first) fallbacks++;
+        return true;
+    }
+}
+
+void CSolver::expand(CState &state, vector<CState> &children) {
+    int delta_x, delta_y;
+    deltas(state.node, state.partition, delta_x, delta_y);
+
+    // Bound both children now, so only the promising ones enter the queue
+    for (int value = 0; value < 2; value++) {
+        const int x_count = state.x_count + (value == 0 ? 1 : 0);
+        if (x_count > a || a - x_count > n - state.node - 1) continue; // Subset X cannot reach 'a' elements
+        const int cut_weight = state.cut_weight + (value == 0 ? delta_y : delta_x);
+        state.partition[state.node] = value;
+
+        #pragma omp atomic update
+        n_rec++;
+        const int bound = cut_weight + low_bound(state.node + 1, state.partition);
+        if (bound > gap.limit(min_cut_weight)) continue;
+
+        // Small subtrees are enumerated right away, queueing them costs more than the tail kernel saves
+        if (n - state.node - 1 <= TAIL_SIZE) {
+            tail(state.node + 1, x_count, cut_weight, state.partition);
+            continue;
+        }
+        children.emplace_back(state.node + 1, x_count, cut_weight, bound, state.partition);
+    }
+}
+
+void CSolver::set_gap(const CGap &gap) {
+    this->gap = gap;
+}
+
+void CSolver::solve() {
+    // Start from a greedy cut, the search finds it again together with any ties unless the gap prunes its path
+    dive();
+
+    vector<int> partition(n, -1); // Partition of the nodes
+    int node = 0;
+    if (2 * a == n) {
+        partition[0] = 0; // If X and Y must be equal in size, placing the first node in X avoids duplicate results
+        node = 1;
+    }
+    n_rec++;
+    open[node].emplace_back(node, node, 0, low_bound(node, partition), partition);
+    open_size = peak_open = 1;
+
+    #pragma omp parallel
+    {
+        CState state;
+        vector<CState> children;
+        bool depth_first;
+        while (pop(state, depth_first)) {
+            if (state.bound <= gap.limit(min_cut_weight)) {
+                if (n - state.node <= TAIL_SIZE) {
+                    tail(state.node, state.x_count, state.cut_weight, state.partition);
+                } else if (depth_first) {
+                    dfs(state.node, state.x_count, state.cut_weight, state.partition);
+                } else {
+                    expand(state, children);
+                }
+            }
+
+            lock_guard<mutex> lock(open_mutex);
+            for (auto &child: children) {
+                vector<CState> &heap = open[child.node];
+                heap.push_back(move(child));
+                push_heap(heap.begin(), heap.end(), CWorseBound());
+                open_size++;
+            }
+            children.clear();
+            peak_open = max(peak_open, open_size);
+            busy--;
+            open_ready.notify_all();
+        }
+    }
+    sort(best_partitions.begin(), best_partitions.end()); // Threads find ties out of order
+    best_partitions.erase(unique(best_partitions.begin(), best_partitions.end()), best_partitions.end());
+    print_solution();
+}
+
+void CSolver::print_solution() const {
+    cout << "Min Cut weight: " << min_cut_weight << endl;
+    if (!gap.is_exact()) cout << "Guaranteed ratio: " << gap.ratio(min_cut_weight) << endl;
+    for (const auto &it: best_partitions) {
+        cout << "X: ";
+        for (int j = 0; j < n; j++) if (it[j] == 0) cout << j << " ";
+        cout << endl << "Y: ";
+        for (int j = 0; j < n; j++) if (it[j] == 1) cout << j << " ";
+        cout << endl;
+    }
+    cout << "Recursion: " << n_rec << endl;
+    cout << "Peak open states: " << peak_open << " (" << peak_open * (sizeof(CState) + n * sizeof(int)) / (1024 * 1024)
+            << " MiB)" << endl;
+    cout << "Depth-first fallbacks: " << fallbacks << endl;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "CFileReader.h"
+#include "CGap.h"
+
+using namespace std;
+
+constexpr double SPARSE_DENSITY = 0.75; // Graphs below this density use the sparse kernels
+constexpr int TAIL_SIZE = 10; // Subtrees with at most this many unassigned nodes are enumerated by the tail kernel
+constexpr int TAIL_LANES = 16; // Vector width of the tail kernel, at least TAIL_SIZE
+constexpr int MEMORY_CAP_MB = 256; // Default size of the open states before falling back to depth-first search
+
+typedef int CTailVector __attribute__((vector_size(4 * TAIL_LANES))); // One lane per unassigned node
+
+struct CState {
+    int node = 0;
+    int x_count = 0;
+    int cut_weight = 0;
+    int bound = 0; // Cut weight plus the lower bound for the unassigned nodes
+    vector<int> partition{};
+
+    CState() = default;
+
+    CState(const int node, const int x_count, const int cut_weight, const int bound, const vector<int> &partition)
+        : node(node), x_count(x_count), cut_weight(cut_weight), bound(bound), partition(partition) {
+    }
+};
+
+struct CWorseBound {
+    bool operator()(const CState &left, const CState &right) const {
+        return left.bound > right.bound;
+    }
+};
+
+class CSolver {
+    const int n, a;
+    const vector<vector<int> > graph;
+    const CSparseGraph sparse; // Same graph as neighbour lists
+    const bool use_sparse; // Iterate only over real neighbours
+
+    int min_cut_weight; // Weight of the minimum cut
+    CGap gap; // Allowed distance from the optimum, exact by default
+    vector<vector<int> > best_partitions; // Best solutions
+    long long n_rec; // Number of bounded search tree nodes
+
+    mutex open_mutex; // Guards the open states and the number of busy threads
+    condition_variable open_ready;
+    vector<vector<CState> > open; // Heaps of open states by depth, lowest bound on top
+    long long open_size; // Number of open states
+    const long long max_open; // Open states that fit into the memory cap
+    long long peak_open; // Largest number of open states
+    long long fallbacks; // Deepest states searched depth-first because of the memory cap
+    int busy; // Threads expanding a state outside the lock
+
+    int low_bound(int node, const vector<int> &partition) const;
+
+    void deltas(int node, const vector<int> &partition, int &delta_x, int &delta_y) const;
+
+    void dive();
+
+    bool pop(CState &state, bool &depth_first);
+
+    void expand(CState &state, vector<CState> &children);
+
+public:
+    CSolver(int n, int a, const vector<vector<int> > &graph, const CSparseGraph &sparse, int memory_mb);
+
+    void dfs(int node, int x_count, int cut_weight, vector<int> &partition);
+
+    void tail(int node, int x_count, int cut_weight, vector<int> &partition);
+
+    void record_partition(int cut_weight, const vector<int> &partition);
+
+    void set_gap(const CGap &gap);
+
+    void solve();
+
+    void print_solution() const;
+};
@@ -0,0 +1,61 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include "CFileReader.h"
+#include "CSolver.h"
+
+using namespace std;
+using namespace chrono;
+
+int main(const int argc, char *argv[]) {
+    if (argc < 3 || argc % 2 == 0) {
+        cerr << "<Size of set X = 'a'> <input_file> [--memory <MiB of open states>]"
+                " [--gap <weight | percent%>]" << endl;
+        return 1;
+    }
+
+    // Start measuring execution time
+    const auto start_time = high_resolution_clock::now();
+
+    // Read the size of set X
+    int a;
+    CFileReader file_reader;
+    if (!file_reader.readInteger(a, argv[1])) {
+        return 1;
+    }
+
+    // Read the graph from the input file
+    int n;
+    vector<vector<int> > graph;
+    CSparseGraph sparse;
+    if (!file_reader.readFromFile(argv[2], graph, sparse, n)) {
+        return 1;
+    }
+
+    // Open states beyond the memory cap are searched depth-first, the gap allows a cut above the optimum
+    int memory_mb = MEMORY_CAP_MB;
+    CGap gap;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        const string option = argv[i];
+        if (option == "--memory") {
+            if (!file_reader.readInteger(memory_mb, argv[i + 1])) return 1;
+        } else if (option == "--gap") {
+            if (!gap.parse(argv[i + 1])) return 1;
+        } else {
+            cerr << "Unknown option: " << option << endl;
+            return 1;
+        }
+    }
+
+    // Solve the problem
+    CSolver solver(n, a, graph, sparse, memory_mb);
+    solver.set_gap(gap);
+    solver.solve();
+
+    // Measure and display execution time
+    const auto end_time = high_resolution_clock::now();
+    const duration<double> elapsed = end_time - start_time;
+    cout << "Time: " << elapsed.count() << " seconds" << endl;
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "CArena.h"
+#include <algorithm>
+#include <cstring>
+
+CPartitionPool::CPartitionPool(const size_t size) : size(size), allocations(0), reuses(0) {
+    free_buffers.reserve(POOL_RESERVE);
+}
+
+vector<int> *CPartitionPool::acquire() {
+    if (!free_buffers.empty()) {
+        reuses++;
+        vector<int> *buffer = free_buffers.back();
+        free_buffers.pop_back();
+        return buffer;
+    }
+    allocations++;
+    owned.push_back(make_unique<vector<int> >(size));
+    return owned.back().get();
+}
+
+void CPartitionPool::release(vector<int> *buffer) {
+    if (free_buffers.size() == free_buffers.capacity()) allocations++; // The free list itself grows
+    free_buffers.push_back(buffer);
+}
+
+long long CPartitionPool::get_allocations() const {
+    return allocations;
+}
+
+long long CPartitionPool::get_reuses() const {
+    return reuses;
+}
+
+CPartitionArena::CPartitionArena(const size_t size) : size(size), count(0), allocations(0) {
+}
+
+void CPartitionArena::push_back(const vector<int> &partition) {
+    if ((count + 1) * size > data.size()) {
+        allocations++;
+        data.resize(max(2 * data.size(), (count + 1) * size));
+    }
+    memcpy(&data[count * size], partition.data(), size * sizeof(int));
+    count++;
+}
+
+void CPartitionArena::clear() {
+    count = 0;
+}
+
+size_t CPartitionArena::get_count() const {
+    return count;
+}
+
+const int *CPartitionArena::operator[](const size_t i) const {
+    return &data[i * size];
+}
+
+void CPartitionArena::sort_unique() {
+    // Sort an index instead of moving partitions around, then compact the storage in the new order
+    vector<size_t> order(count);
+    for (size_t i = 0; i < count; i++) order[i] = i;
+    const auto less = [this](const size_t i, const size_t j) {
+        return lexicographical_compare(&data[i * size], &data[(i + 1) * size],
+                                       &data[j * size], &data[(j + 1) * size]);
+    };
+    const auto equal = [this](const size_t i, const size_t j) {
+        return memcmp(&data[i * size], &data[j * size], size * sizeof(int)) == 0;
+    };
+    sort(order.begin(), order.end(), less);
+    order.erase(unique(order.begin(), order.end(), equal), order.end());
+
+    vector<int> sorted(order.size() * size);
+    for (size_t i = 0; i < order.size(); i++)
+        memcpy(&sorted[i * size], &data[order[i] * size], size * sizeof(int));
+    data.swap(sorted);
+    count = order.size();
+}
+
+long long CPartitionArena::get_allocations() const {
+    return allocations;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+constexpr int POOL_RESERVE = 64; // Free list slots reserved per thread
+
+// Partition buffers of one thread, handed back to the free list instead of the heap
+class alignas(64) CPartitionPool {
+    size_t size; // Nodes per partition
+    vector<unique_ptr<vector<int> > > owned; // Buffers created by this pool, freed with it
+    vector<vector<int> *> free_buffers; // Buffers ready to be handed out, possibly created by another pool
+    long long allocations; // Requests that went to the heap
+    long long reuses; // Requests served from the free list
+
+public:
+    explicit CPartitionPool(size_t size = 0);
+
+    vector<int> *acquire();
+
+    void release(vector<int> *buffer);
+
+    long long get_allocations() const;
+
+    long long get_reuses() const;
+};
+
+// Recorded partitions stored back to back, clearing keeps the memory for the next ones
+class CPartitionArena {
+    size_t size; // Nodes per partition
+    vector<int> data;
+    size_t count; // Partitions stored
+    long long allocations; // Times the storage had to grow
+
+public:
+    explicit CPartitionArena(size_t size = 0);
+
+    void push_back(const vector<int> &partition);
+
+    void clear();
+
+    size_t get_count() const;
+
+    const int *operator[](size_t i) const;
+
+    void sort_unique();
+
+    long long get_allocations() const;
+};
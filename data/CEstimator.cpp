@@ -0,0 +1,121 @@
+#include "CEstimator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+CEstimator::CEstimator(const int n, const int a, const vector<vector<int> > &graph, const int tail_size,
+                       const unsigned seed)
+    : n(n), a(a), graph(graph), tail_size(tail_size), random(seed), levels(n + 1, 0.0), nodes(0), spread(0),
+      incumbent(numeric_limits<int>::max()) {
+}
+
+int CEstimator::probe(const bool greedy, const bool count, double &estimate) {
+    // Follow one random path of the dfs, weighting each level by the product of the branching factors (Knuth)
+    vector<int> partition(n, -1);
+    int node = 0, x_count = 0, cut_weight = 0;
+    if (2 * a == n) {
+        partition[0] = 0;
+        node = x_count = 1;
+    }
+
+    double weight = 1;
+    estimate = 0;
+    bool counting = count;
+    while (true) {
+        if (counting) {
+            levels[node] += weight;
+            estimate += weight;
+        }
+        if (cut_weight > incumbent) return numeric_limits<int>::max();
+        if (node == n) {
+            if (x_count != a) return numeric_limits<int>::max();
+            if (cut_weight < incumbent) {
+                incumbent = cut_weight; // Lowered together with its partition, by every kind of probe
+                incumbent_partition = partition;
+            }
+            return cut_weight;
+        }
+        if (n - node <= tail_size) counting = false; // The tail kernel replaces the rest of the subtree
+
+        int delta_x = 0, delta_y = 0; // Same bounds as dfs
+        for (int i = 0; i < node; i++) {
+            if (partition[i] == 0) delta_x += graph[i][node];
+            else delta_y += graph[i][node];
+        }
+        int low_bound = 0;
+        for (int i = node; i < n; i++) {
+            int low_bound_x = 0, low_bound_y = 0;
+            for (int j = 0; j < node; j++) {
+                if (partition[j] == 0) low_bound_x += graph[j][i];
+                else low_bound_y += graph[j][i];
+            }
+            low_bound += min(low_bound_x, low_bound_y);
+        }
+        if (low_bound + cut_weight > incumbent) return numeric_limits<int>::max();
+
+        // Both children are visited by dfs unless X is already full
+        const int children = x_count < a ? 2 : 1;
+        weight *= children;
+        bool to_x = x_count < a;
+        if (children == 2) to_x = greedy ? delta_y <= delta_x : random() % 2 == 0;
+
+        partition[node] = to_x ? 0 : 1;
+        cut_weight += to_x ? delta_y : delta_x;
+        x_count += to_x ? 1 : 0;
+        node++;
+    }
+}
+
+void CEstimator::run(const int probes) {
+    // Find an incumbent first, the real search prunes with one almost from the start
+    double estimate;
+    probe(true, false, estimate);
+    for (int i = 0; i < probes / 4; i++) probe(false, false, estimate);
+
+    fill(levels.begin(), levels.end(), 0.0);
+    double sum = 0, sum_squares = 0;
+    for (int i = 0; i < probes; i++) {
+        probe(false, true, estimate);
+        sum += estimate;
+        sum_squares += estimate * estimate;
+    }
+    for (auto &level: levels) level /= probes;
+    nodes = sum / probes;
+    const double variance = max(0.0, sum_squares / probes - nodes * nodes);
+    spread = nodes > 0 ? sqrt(variance) / nodes : 0;
+}
+
+double CEstimator::get_nodes() const {
+    return nodes;
+}
+
+int CEstimator::get_incumbent() const {
+    return incumbent;
+}
+
+const vector<int> &CEstimator::get_incumbent_partition() const {
+    return incumbent_partition;
+}
+
+int CEstimator::threads(const int available) const {
+    // Clamp before the cast, estimates of large trees do not fit in an int
+    return max(1, static_cast<int>(min<double>(available, nodes / NODES_PER_THREAD)));
+}
+
+int CEstimator::task_depth(const int threads) const {
+    // First depth wide enough to keep every thread busy, deeper subtrees run without tasks
+    for (int depth = 0; depth < n - tail_size; depth++)
+        if (levels[depth] >= threads * TASKS_PER_THREAD) return depth;
+    return max(0, n - tail_size);
+}
+
+int CEstimator::frontier_size(const int threads) const {
+    const double states = nodes / NODES_PER_STATE;
+    return static_cast<int>(min(max(states, threads * 4.0), threads * 256.0));
+}
+
+string CEstimator::engine() const {
+    if (nodes < SEQ_NODES) return "seq";
+    if (nodes > MPI_NODES) return "mpi";
+    return spread > IRREGULAR_SPREAD ? "task" : "data"; // Irregular trees need dynamic load balancing
+}
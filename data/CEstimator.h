@@ -0,0 +1,48 @@
+#pragma once
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+constexpr int ESTIMATE_PROBES = 200; // Random probes per estimate
+constexpr double SEQ_NODES = 1e5; // Smaller trees are not worth starting threads for
+constexpr double MPI_NODES = 1e10; // Larger trees are worth distributing over several machines
+constexpr double NODES_PER_THREAD = 2e4; // Minimal work that justifies one more thread
+constexpr double NODES_PER_STATE = 1e4; // Desired work per starting state of the data engine
+constexpr int TASKS_PER_THREAD = 32; // Tasks per thread at the task cutoff depth
+constexpr double IRREGULAR_SPREAD = 2.0; // Relative spread of the probes above which dynamic tasks balance better
+
+class CEstimator {
+    const int n, a;
+    const vector<vector<int> > &graph;
+    const int tail_size; // The search enumerates subtrees this small at once
+
+    mt19937 random;
+    vector<double> levels; // Estimated number of dfs calls at each depth
+    double nodes; // Estimated number of dfs calls in total
+    double spread; // Standard deviation of the probe estimates relative to their mean
+    int incumbent; // Best cut found by the probes, used for pruning like the real search
+    vector<int> incumbent_partition; // Partition of that cut
+
+    int probe(bool greedy, bool count, double &estimate);
+
+public:
+    CEstimator(int n, int a, const vector<vector<int> > &graph, int tail_size, unsigned seed = 1);
+
+    void run(int probes);
+
+    double get_nodes() const;
+
+    int get_incumbent() const;
+
+    const vector<int> &get_incumbent_partition() const;
+
+    int threads(int available) const;
+
+    int task_depth(int threads) const;
+
+    int frontier_size(int threads) const;
+
+    string engine() const;
+};
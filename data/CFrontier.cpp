@@ -0,0 +1,103 @@
+#include "CFrontier.h"
+#include <algorithm>
+
+CFrontier::CFrontier(const int n, const int a, const vector<vector<int> > &graph)
+    : n(n), a(a), graph(graph), depth(2 * a == n ? 1 : 0) {
+    // Node 0 stays in X when both sets have the same size, the mirrored states are redundant
+    x_counts.push_back(depth);
+    cut_weights.push_back(0);
+    low_bounds.push_back(0);
+    masks.push_back(0);
+}
+
+void CFrontier::expand(const int limit) {
+    const int node = depth; // Node assigned in this step
+    const size_t count = size();
+
+    // Weight from each unassigned node to all assigned nodes, the part towards Y depends on the state
+    vector<int> assigned_weight(n, 0);
+    for (int j = node; j < n; j++)
+        for (int i = 0; i < node; i++)
+            assigned_weight[j] += graph[i][j];
+
+    vector<int> next_x_counts, next_cut_weights, next_low_bounds;
+    vector<uint64_t> next_masks;
+    next_x_counts.reserve(2 * count);
+    next_cut_weights.reserve(2 * count);
+    next_low_bounds.reserve(2 * count);
+    next_masks.reserve(2 * count);
+
+    for (size_t first = 0; first < count; first += BATCH_LANES) {
+        const int lanes = static_cast<int>(min(count - first, static_cast<size_t>(BATCH_LANES)));
+        CMaskVector mask = {};
+        for (int k = 0; k < lanes; k++) mask[k] = masks[first + k];
+        CBatchVector in_y_bits[MASK_BITS]; // Lane k is 1 if node i is in Y in state k
+        for (int i = 0; i < node; i++) in_y_bits[i] = __builtin_convertvector((mask >> i) & 1, CBatchVector);
+
+        // Deltas of the node and the bounds of both children for all states of the batch at once
+        CBatchVector delta_y = {}, low_bound_x = {}, low_bound_y = {};
+        for (int j = node; j < n; j++) {
+            CBatchVector in_y = {};
+            for (int i = 0; i < node; i++) in_y += in_y_bits[i] * graph[i][j];
+            const CBatchVector in_x = assigned_weight[j] - in_y;
+            if (j == node) {
+                delta_y = in_y;
+                continue;
+            }
+            const int weight = graph[node][j];
+            const CBatchVector child_x = in_x + weight, child_y = in_y + weight;
+            low_bound_x += child_x < in_y ? child_x : in_y; // Node goes to X
+            low_bound_y += in_x < child_y ? in_x : child_y; // Node goes to Y
+        }
+        const CBatchVector delta_x = assigned_weight[node] - delta_y;
+
+        // Keep only children that fit the set sizes and whose bound does not exceed the limit
+        for (int k = 0; k < lanes; k++) {
+            const size_t s = first + k;
+            const int to_x = cut_weights[s] + delta_y[k], to_y = cut_weights[s] + delta_x[k];
+            if (x_counts[s] < a && to_x + low_bound_x[k] <= limit) {
+                next_x_counts.push_back(x_counts[s] + 1);
+                next_cut_weights.push_back(to_x);
+                next_low_bounds.push_back(low_bound_x[k]);
+                next_masks.push_back(masks[s]);
+            }
+            if (node + 1 - x_counts[s] <= n - a && to_y + low_bound_y[k] <= limit) {
+                next_x_counts.push_back(x_counts[s]);
+                next_cut_weights.push_back(to_y);
+                next_low_bounds.push_back(low_bound_y[k]);
+                next_masks.push_back(masks[s] | uint64_t(1) << node);
+            }
+        }
+    }
+
+    depth++;
+    x_counts.swap(next_x_counts);
+    cut_weights.swap(next_cut_weights);
+    low_bounds.swap(next_low_bounds);
+    masks.swap(next_masks);
+}
+
+int CFrontier::get_depth() const {
+    return depth;
+}
+
+size_t CFrontier::size() const {
+    return masks.size();
+}
+
+int CFrontier::x_count(const size_t i) const {
+    return x_counts[i];
+}
+
+int CFrontier::cut_weight(const size_t i) const {
+    return cut_weights[i];
+}
+
+int CFrontier::low_bound(const size_t i) const {
+    return low_bounds[i];
+}
+
+void CFrontier::decode(const size_t i, vector<int> &partition) const {
+    partition.assign(n, -1);
+    for (int j = 0; j < depth; j++) partition[j] = static_cast<int>((masks[i] >> j) & 1);
+}
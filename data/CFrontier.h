@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+constexpr int BATCH_LANES = 8; // Sibling states evaluated together by the frontier kernel
+constexpr int MASK_BITS = 64; // Assigned nodes a packed mask can hold
+
+typedef int CBatchVector __attribute__((vector_size(4 * BATCH_LANES))); // One lane per state
+typedef uint64_t CMaskVector __attribute__((vector_size(8 * BATCH_LANES))); // Masks of the states in a batch
+
+// Starting states of one depth stored as separate arrays, bit i of a mask is set if node i is in Y
+class CFrontier {
+    const int n, a;
+    const vector<vector<int> > &graph;
+    int depth; // Every state has the nodes [0, depth) assigned
+
+    vector<int> x_counts;
+    vector<int> cut_weights;
+    vector<int> low_bounds; // Lower bound of the future cut weight, the same one dfs computes
+    vector<uint64_t> masks;
+
+public:
+    CFrontier(int n, int a, const vector<vector<int> > &graph);
+
+    void expand(int limit);
+
+    int get_depth() const;
+
+    size_t size() const;
+
+    int x_count(size_t i) const;
+
+    int cut_weight(size_t i) const;
+
+    int low_bound(size_t i) const;
+
+    void decode(size_t i, vector<int> &partition) const;
+};
@@ -0,0 +1,45 @@
+#include "CGap.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+CGap::CGap() : relative(0), absolute(0) {
+}
+
+bool CGap::parse(const string &argv) {
+    // "2%" allows 2 % above the optimum, "50" allows a cut weight up to 50 above it
+    const bool percent = !argv.empty() && argv.back() == '%';
+    const string number = percent ? argv.substr(0, argv.size() - 1) : argv;
+    size_t used = 0;
+    try {
+        if (percent) relative = stod(number, &used) / 100;
+        else absolute = stoi(number, &used);
+    } catch (...) {
+        used = 0;
+    }
+    if (used == 0 || used != number.size() || relative < 0 || absolute < 0) {
+        cerr << "Invalid gap: " << argv << endl;
+        return false;
+    }
+    return true;
+}
+
+bool CGap::is_exact() const {
+    return relative == 0 && absolute == 0;
+}
+
+int CGap::limit(const int incumbent) const {
+    // Subtrees whose bound is above this value are pruned, the exact search keeps the ties
+    if (incumbent == numeric_limits<int>::max()) return incumbent;
+    if (relative > 0) return static_cast<int>(floor(incumbent / (1 + relative)));
+    return incumbent - absolute;
+}
+
+double CGap::ratio(const int cut_weight) const {
+    // Every pruned subtree only holds cuts above limit(cut_weight), so the optimum is at least one more
+    const int optimum = min(cut_weight, limit(cut_weight) + 1);
+    if (cut_weight == 0) return 1;
+    if (optimum <= 0) return numeric_limits<double>::infinity();
+    return static_cast<double>(cut_weight) / optimum;
+}
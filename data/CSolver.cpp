@@ -2,58 +2,83 @@
 #include <algorithm>
 #include <iostream>
 #include <limits>
-#include <queue>
 #include <omp.h>
+#include "CEstimator.h"
 
-CSolver::CSolver(const int n, const int a, const vector<vector<int> > &graph)
-    : n(n), a(a), graph(graph), min_cut_weight(numeric_limits<int>::max()) {
+CSolver::CSolver(const int n, const int a, const vector<vector<int> > &graph, const CSparseGraph &sparse)
+    : n(n), a(a), graph(graph), sparse(sparse), use_sparse(sparse.density < SPARSE_DENSITY),
+      min_cut_weight(numeric_limits<int>::max()), best_partitions(n) {
 }
 
 void CSolver::dfs(const int node, const int x_count, const int cut_weight, vector<int> &partition) {
-    // Prune the search if the current cut weight exceeds the best found so far
-    if (cut_weight > min_cut_weight)
+    // Work on the graph and best cut weight of this thread's NUMA node
+    const int numa_node = thread_node[omp_get_thread_num()];
+    const CReplica &replica = replicas[numa_node];
+    const CNodeBound &bound = node_bounds[numa_node];
+
+    // Prune the search if the current cut weight exceeds the best found so far, less the allowed gap
+    const int limit = gap.limit(bound.min_cut_weight);
+    if (cut_weight > limit)
         return;
 
     // If all nodes are processed, check if a valid partition is found
     if (node == n) {
-        // Ensure the subset X has exactly 'a' elements
-        if (x_count == a) {
-            #pragma omp critical
-            {
-                if (cut_weight == min_cut_weight) {
-                    best_partitions.push_back(partition); // Store another optimal partition
-                } else if (cut_weight < min_cut_weight) {
-                    min_cut_weight = cut_weight; // Update the best cut weight found
-                    best_partitions.clear(); // Clear previous partitions
-                    best_partitions.push_back(partition); // Store the new best partition
-                }
-            }
-        }
+        if (x_count == a) // Ensure the subset X has exactly 'a' elements
+            record_partition(cut_weight, partition);
         return;
     }
 
     int delta_x = 0, delta_y = 0; // Contribution to cut weight when assigning node to X or Y
-    for (int i = 0; i < node; i++) {
-        if (partition[i] == 0)
-            delta_x += graph[i][node]; // Adding edges between node and subset X
-        else
-            delta_y += graph[i][node]; // Adding edges between node and subset Y
-    }
-
     int low_bound_x = 0, low_bound_y = 0, low_bound = 0; // Compute a lower bound for future cut weight
-    for (int i = node; i < n; i++) {
-        for (int j = 0; j < node; j++) {
-            if (partition[j] == 0)
-                low_bound_x += graph[j][i];
+    if (use_sparse) {
+        // Neighbour lists are sorted, so only the neighbours already assigned are visited
+        const int *neighbours = replica.sparse.neighbours.data(), *weights = replica.sparse.weights.data();
+        const int *offsets = replica.sparse.offsets.data();
+        for (int e = offsets[node]; e < offsets[node + 1] && neighbours[e] < node; e++) {
+            if (partition[neighbours[e]] == 0)
+                delta_x += weights[e]; // Adding edges between node and subset X
             else
-                low_bound_y += graph[j][i];
+                delta_y += weights[e]; // Adding edges between node and subset Y
+        }
+
+        for (int i = node; i < n; i++) {
+            for (int e = offsets[i]; e < offsets[i + 1] && neighbours[e] < node; e++) {
+                if (partition[neighbours[e]] == 0)
+                    low_bound_x += weights[e];
+                else
+                    low_bound_y += weights[e];
+            }
+            low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+            low_bound_x = 0, low_bound_y = 0;
+        }
+    } else {
+        for (int i = 0; i < node; i++) {
+            if (partition[i] == 0)
+                delta_x += replica.graph[i][node]; // Adding edges between node and subset X
+            else
+                delta_y += replica.graph[i][node]; // Adding edges between node and subset Y
+        }
+
+        for (int i = node; i < n; i++) {
+            for (int j = 0; j < node; j++) {
+                if (partition[j] == 0)
+                    low_bound_x += replica.graph[j][i];
+                else
+                    low_bound_y += replica.graph[j][i];
+            }
+            low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+            low_bound_x = 0, low_bound_y = 0;
         }
-        low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
-        low_bound_x = 0, low_bound_y = 0;
     }
 
     // Stop if the minimum possible future cut weight is already worse than the best found
-    if (low_bound + cut_weight > min_cut_weight) {
+    if (low_bound + cut_weight > limit) {
+        return;
+    }
+
+    // Small subtrees are enumerated at once instead of recursing node by node
+    if (n - node <= TAIL_SIZE) {
+        tail(node, x_count, cut_weight, partition);
         return;
     }
 
@@ -67,69 +92,166 @@ void CSolver::dfs(const int node, const int x_count, const int cut_weight, vecto
     dfs(node + 1, x_count, cut_weight + delta_x, partition);
 }
 
-vector<CState> CSolver::starting_states() const {
-    const int enough_states = n * 10; // Number of starting states
-    queue<CState> q;
-
-    if (2 * a == n) {
-        vector<int> partition(n, -1);
-        partition[0] = 0;
-        q.emplace(1, 1, 0, partition);
-    } else {
-        q.emplace(0, 0, 0, vector<int>(n, -1));
-    }
-
-    while (q.size() < enough_states) {
-        CState state = q.front();
-        const int node = state.node;
-        if (node > n - 2) break;
-        q.pop();
+void CSolver::tail(const int node, const int x_count, const int cut_weight, vector<int> &partition) {
+    const int remaining = n - node, x_left = a - x_count;
+    if (x_left < 0 || x_left > remaining)
+        return;
+    const CReplica &replica = replicas[thread_node[omp_get_thread_num()]];
+    const CNodeBound &bound = node_bounds[thread_node[omp_get_thread_num()]];
 
-        int delta_x = 0, delta_y = 0; // Contribution to cut weight when assigning node to X or Y
-        for (int i = 0; i < node; i++) {
-            if (state.partition[i] == 0)
-                delta_x += graph[i][node]; // Adding edges between node and subset X
+    // Cost of each unassigned node towards the assigned ones, and the weights among the unassigned nodes
+    int cost_x[TAIL_LANES], cost_y[TAIL_LANES], degree[TAIL_LANES];
+    CTailVector rows[TAIL_LANES] = {};
+    int total = cut_weight; // Cut weight of the current mask, which starts with every unassigned node in Y
+    for (int u = 0; u < remaining; u++) {
+        cost_x[u] = cost_y[u] = degree[u] = 0;
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0)
+                cost_y[u] += replica.graph[j][node + u]; // Cut when u goes to Y
             else
-                delta_y += graph[i][node]; // Adding edges between node and subset Y
+                cost_x[u] += replica.graph[j][node + u]; // Cut when u goes to X
         }
+        for (int v = 0; v < remaining; v++) {
+            if (v == u) continue;
+            rows[u][v] = replica.graph[node + u][node + v];
+            degree[u] += rows[u][v];
+        }
+        total += cost_y[u];
+    }
 
-        // Add the node to subset X
-        CState left = CState(node + 1, state.x_count + 1, state.cut_weight + delta_y, state.partition);
-        left.partition[node] = 0;
-        q.push(left);
-
-        // Add the node to subset Y
-        CState right = CState(node + 1, state.x_count, state.cut_weight + delta_x, state.partition);
-        right.partition[node] = 1;
-        q.push(right);
+    // Walk all subsets in Gray code order, each step moves one node and updates every lane at once
+    CTailVector in_x = {}; // Weight from each unassigned node to the unassigned nodes in X
+    int mask = 0, count = 0;
+    for (int step = 0; step < 1 << remaining; step++) {
+        if (step > 0) {
+            const int u = __builtin_ctz(step);
+            mask ^= 1 << u;
+            if ((mask >> u) & 1) {
+                total += cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                in_x += rows[u];
+                count++;
+            } else {
+                in_x -= rows[u];
+                total -= cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                count--;
+            }
+        }
+        if (count == x_left && total <= bound.min_cut_weight) {
+            for (int u = 0; u < remaining; u++) partition[node + u] = (mask >> u) & 1 ? 0 : 1;
+            record_partition(total, partition);
+        }
     }
+}
 
-    // Convert the queue to a vector
-    std::vector<CState> states(q.size());
-    for (int i = 0; i < states.size(); i++) {
-        states[i] = q.front();
-        q.pop();
+void CSolver::record_partition(const int cut_weight, const vector<int> &partition) {
+    #pragma omp critical
+    {
+        if (cut_weight == min_cut_weight) {
+            best_partitions.push_back(partition); // Store another optimal partition
+        } else if (cut_weight < min_cut_weight) {
+            min_cut_weight = cut_weight; // Update the best cut weight found
+            for (auto &copy: node_bounds) copy.min_cut_weight = cut_weight; // Crosses nodes only here
+            best_partitions.clear(); // Clear previous partitions
+            best_partitions.push_back(partition); // Store the new best partition
+        }
     }
+}
+
+CFrontier CSolver::starting_states(const int enough_states, const int limit) const {
+    // Expand whole levels at once, the frontier evaluates sibling states in batches
+    CFrontier states(n, a, graph);
+    while (states.size() < enough_states && states.get_depth() < min(n - 1, MASK_BITS))
+        states.expand(limit);
     return states;
 }
 
+void CSolver::set_gap(const CGap &gap) {
+    this->gap = gap;
+}
+
 void CSolver::solve() {
-    vector<CState> states = starting_states(); // Generate starting states for the search
+    // Size the thread team and the number of starting states to the estimated search tree
+    CEstimator estimator(n, a, graph, TAIL_SIZE);
+    estimator.run(ESTIMATE_PROBES);
+    const int threads = estimator.threads(omp_get_max_threads());
+    // Start from the probes' best cut, dfs finds it again unless the gap prunes its path
+    min_cut_weight = estimator.get_incumbent();
+    if (!estimator.get_incumbent_partition().empty())
+        best_partitions.push_back(estimator.get_incumbent_partition());
+    const CFrontier states = starting_states(estimator.frontier_size(threads), gap.limit(min_cut_weight));
+
+    const int nodes = topology.nodes();
+    thread_node.resize(threads);
+    vector<int> node_threads(nodes, 0);
+    for (int thread = 0; thread < threads; thread++) {
+        thread_node[thread] = topology.node_of_thread(thread);
+        node_threads[thread_node[thread]]++;
+    }
+
+    // Every NUMA node gets a contiguous block of states proportional to its number of threads
+    vector<int> block_end(nodes);
+    replicas.assign(nodes, CReplica());
+    pools.clear();
+    for (int thread = 0; thread < threads; thread++) pools.emplace_back(n);
+    node_bounds.assign(nodes, CNodeBound{min_cut_weight, 0});
+    for (int node = 0, assigned = 0, end = 0; node < nodes; node++) {
+        node_bounds[node].next_state = end;
+        assigned += node_threads[node];
+        end = static_cast<int>(static_cast<long long>(states.size()) * assigned / threads);
+        block_end[node] = end;
+    }
 
-    #pragma omp parallel for
-    for (int i = 0; i < states.size(); i++) {
-        dfs(states[i].node, states[i].x_count, states[i].cut_weight, states[i].partition);
+    const cpu_set_t affinity = CTopology::get_affinity(); // The calling thread is pinned as thread 0
+    #pragma omp parallel num_threads(threads)
+    {
+        // Pin the thread, then let the first thread on each node copy the graph so the pages are allocated there
+        const int thread = omp_get_thread_num();
+        topology.pin_thread(thread);
+        #pragma omp critical
+        {
+            CReplica &replica = replicas[thread_node[thread]];
+            if (replica.graph.empty()) {
+                replica.graph = graph;
+                replica.sparse = sparse;
+            }
+        }
+        #pragma omp barrier
+
+        // Work on the own node's block first, then help the other nodes
+        for (int k = 0; k < nodes; k++) {
+            const int node = (thread_node[thread] + k) % nodes;
+            while (true) {
+                int i;
+                #pragma omp atomic capture
+                i = node_bounds[node].next_state++;
+                if (i >= block_end[node]) break;
+                vector<int> *partition = pools[thread].acquire(); // Reused for every state of this thread
+                states.decode(i, *partition);
+                dfs(states.get_depth(), states.x_count(i), states.cut_weight(i), *partition);
+                pools[thread].release(partition);
+            }
+        }
     }
+    CTopology::set_affinity(affinity);
+    best_partitions.sort_unique(); // Threads find ties out of order
     print_solution();
 }
 
 void CSolver::print_solution() const {
     cout << "Min Cut weight: " << min_cut_weight << endl;
-    for (const auto &it: best_partitions) {
+    if (!gap.is_exact()) cout << "Guaranteed ratio: " << gap.ratio(min_cut_weight) << endl;
+    for (size_t i = 0; i < best_partitions.get_count(); i++) {
+        const int *it = best_partitions[i];
         cout << "X: ";
         for (int j = 0; j < n; j++) if (it[j] == 0) cout << j << " ";
         cout << endl << "Y: ";
         for (int j = 0; j < n; j++) if (it[j] == 1) cout << j << " ";
         cout << endl;
     }
+    long long allocations = best_partitions.get_allocations(), reuses = 0;
+    for (const auto &pool: pools) {
+        allocations += pool.get_allocations();
+        reuses += pool.get_reuses();
+    }
+    cout << "Allocations: " << allocations << " (" << reuses << " buffers reused)" << endl;
 }
@@ -1,34 +1,57 @@
 #pragma once
 #include <vector>
+#include "CFileReader.h"
+#include "CFrontier.h"
+#include "CGap.h"
+#include "CTopology.h"
+#include "CArena.h"
 
 using namespace std;
 
-struct CState {
-    int node = 0;
-    int x_count = 0;
-    int cut_weight = 0;
-    vector<int> partition{};
+constexpr double SPARSE_DENSITY = 0.75; // Graphs below this density use the sparse kernels in dfs
+constexpr int TAIL_SIZE = 10; // Subtrees with at most this many unassigned nodes are enumerated by the tail kernel
+constexpr int TAIL_LANES = 16; // Vector width of the tail kernel, at least TAIL_SIZE
 
-    CState() = default;
+typedef int CTailVector __attribute__((vector_size(4 * TAIL_LANES))); // One lane per unassigned node
 
-    CState(const int node, const int x_count, const int cut_weight, const vector<int> &partition)
-        : node(node), x_count(x_count), cut_weight(cut_weight), partition(partition) {
-    }
+struct CReplica {
+    vector<vector<int> > graph; // Dense matrix allocated on one NUMA node
+    CSparseGraph sparse; // Neighbour lists allocated on the same node
+};
+
+struct alignas(64) CNodeBound {
+    int min_cut_weight; // Copy of the best cut weight read by the threads of one NUMA node
+    int next_state; // Next starting state in the block of this node
 };
 
 class CSolver {
     const int n, a;
     const vector<vector<int> > graph;
+    const CSparseGraph sparse; // Same graph as neighbour lists
+    const bool use_sparse; // Iterate only over real neighbours in dfs
 
     int min_cut_weight; // Weight of the minimum cut
-    vector<vector<int> > best_partitions; // Best solutions
+    CGap gap; // Allowed distance from the optimum, exact by default
+    CPartitionArena best_partitions; // Best solutions
+
+    const CTopology topology; // NUMA nodes and CPUs the threads are pinned to
+    vector<int> thread_node; // NUMA node of each thread
+    vector<CReplica> replicas; // Graph copies, one per NUMA node
+    vector<CNodeBound> node_bounds; // Best cut weight and work position, one copy per NUMA node
+    vector<CPartitionPool> pools; // Partition buffers of the starting states, one pool per thread
 
 public:
-    CSolver(int n, int a, const vector<vector<int> > &graph);
+    CSolver(int n, int a, const vector<vector<int> > &graph, const CSparseGraph &sparse);
 
     void dfs(int node, int x_count, int cut_weight, vector<int> &partition);
 
-    vector<CState> starting_states() const;
+    void tail(int node, int x_count, int cut_weight, vector<int> &partition);
+
+    void record_partition(int cut_weight, const vector<int> &partition);
+
+    CFrontier starting_states(int enough_states, int limit) const;
+
+    void set_gap(const CGap &gap);
 
     void solve();
 
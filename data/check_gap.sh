@@ -0,0 +1,58 @@
+#!/bin/bash
+
+# Solves random graphs with --gap and checks that the printed weight is the cut of every printed partition.
+# Usage: ./check_gap.sh [instances]  (run from the data folder after make)
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+INSTANCES=${1:-20}
+GRAPH=$(mktemp)
+trap 'rm -f "$GRAPH"' EXIT
+
+failed=0
+for seed in $(seq 1 "$INSTANCES"); do
+    n=$((12 + seed % 7))
+    a=$((n / 2 - seed % 3))
+    # Small random weights, so that a gap of 100 covers many cuts and dfs rarely improves on the estimator
+    awk -v n="$n" -v seed="$seed" 'BEGIN {
+        srand(seed)
+        for (i = 0; i < n; i++)
+            for (j = i + 1; j < n; j++) w[i, j] = w[j, i] = rand() < 0.5 ? 1 + int(rand() * 20) : 0
+        print n
+        for (i = 0; i < n; i++) {
+            line = ""
+            for (j = 0; j < n; j++) line = line (j ? " " : "") (i == j ? 0 : w[i, j])
+            print line
+        }
+    }' > "$GRAPH"
+
+    for gap in 100 20%; do
+        output=$("$DIR/data" "$a" "$GRAPH" --gap "$gap") || { echo "seed $seed: data failed"; failed=1; continue; }
+        result=$(echo "$output" | awk -v a="$a" -v graph="$GRAPH" '
+            BEGIN {
+                getline n < graph
+                for (i = 0; i < n; i++) {
+                    getline line < graph
+                    split(line, row, " ")
+                    for (j = 0; j < n; j++) w[i, j] = row[j + 1]
+                }
+            }
+            /^Min Cut weight:/ { weight = $4 }
+            /^X:/ {
+                partitions++
+                delete in_x
+                for (k = 2; k <= NF; k++) in_x[$k] = 1
+                if (NF - 1 != a) { print "partition with |X| = " NF - 1; exit }
+                cut = 0
+                for (i = 0; i < n; i++) for (j = i + 1; j < n; j++) if ((i in in_x) != (j in in_x)) cut += w[i, j]
+                if (cut != weight) { print "printed weight " weight ", partition cuts " cut; exit }
+            }
+            END { if (partitions == 0) print "no partition printed" }')
+        if [ -n "$result" ]; then
+            echo "seed $seed (n = $n, a = $a, --gap $gap): $result"
+            failed=1
+        fi
+    done
+done
+
+[ $failed -eq 0 ] && echo "All $INSTANCES instances passed"
+exit $failed
@@ -9,8 +9,8 @@ using namespace std;
 using namespace chrono;
 
 int main(const int argc, char *argv[]) {
-    if (argc != 3) {
-        cerr << "<Size of set X = 'a'> <input_file>" << endl;
+    if (argc != 3 && !(argc == 5 && string(argv[3]) == "--gap")) {
+        cerr << "<Size of set X = 'a'> <input_file> [--gap <weight | percent%>]" << endl;
         return 1;
     }
 
@@ -27,12 +27,20 @@ int main(const int argc, char *argv[]) {
     // Read the graph from the input file
     int n;
     vector<vector<int> > graph;
-    if (!file_reader.readFromFile(argv[2], graph, n)) {
+    CSparseGraph sparse;
+    if (!file_reader.readFromFile(argv[2], graph, sparse, n)) {
+        return 1;
+    }
+
+    // Cut weight or percentage the result may be above the optimum
+    CGap gap;
+    if (argc == 5 && !gap.parse(argv[4])) {
         return 1;
     }
 
     // Solve the problem
-    CSolver solver(n, a, graph);
+    CSolver solver(n, a, graph, sparse);
+    solver.set_gap(gap);
     solver.solve();
 
     // Measure and display execution time
@@ -0,0 +1,212 @@
+#include "CMinCut.h"
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+
+void CCancelToken::cancel() {
+    cancelled.store(true, memory_order_relaxed);
+}
+
+bool CCancelToken::is_cancelled() const {
+    return cancelled.load(memory_order_relaxed);
+}
+
+CMinCut::CMinCut(const int n, const int a, const int *weights, const CMinCutOptions &options)
+    : n(n), a(a), weights(weights), options(options), min_cut_weight(numeric_limits<int>::max()), n_rec(0),
+      stopped(false) {
+}
+
+size_t CMinCut::scratch_size(const int n, const int threads) {
+    // One partition per thread, the starting prefixes are decoded into it from their index
+    return static_cast<size_t>(threads > 0 ? threads : omp_get_max_threads()) * max(n, 0);
+}
+
+int CMinCut::weight(const int i, const int j) const {
+    return weights[static_cast<size_t>(i) * n + j];
+}
+
+bool CMinCut::cancelled() {
+    if (options.cancel != nullptr && options.cancel->is_cancelled())
+        stopped.store(true, memory_order_relaxed);
+    return stopped.load(memory_order_relaxed);
+}
+
+void CMinCut::dfs(const int node, const int x_count, const int cut_weight, int *partition) {
+    #pragma omp atomic update
+    n_rec++; // Atomically increment the recursion counter
+
+    // Prune the search if the current cut weight exceeds the best found so far, or the caller gave up
+    if (cut_weight > min_cut_weight || cancelled())
+        return;
+
+    // If all nodes are processed, check if a valid partition is found
+    if (node == n) {
+        if (x_count == a) // Ensure the subset X has exactly 'a' elements
+            record_partition(cut_weight, partition);
+        return;
+    }
+
+    int delta_x = 0, delta_y = 0; // Contribution to cut weight when assigning node to X or Y
+    for (int i = 0; i < node; i++) {
+        if (partition[i] == 0)
+            delta_x += weight(i, node); // Adding edges between node and subset X
+        else
+            delta_y += weight(i, node); // Adding edges between node and subset Y
+    }
+
+    int low_bound = 0; // Compute a lower bound for future cut weight
+    for (int i = node; i < n; i++) {
+        int low_bound_x = 0, low_bound_y = 0;
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0)
+                low_bound_x += weight(j, i);
+            else
+                low_bound_y += weight(j, i);
+        }
+        low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+    }
+
+    // Stop if the minimum possible future cut weight is already worse than the best found
+    if (low_bound + cut_weight > min_cut_weight) {
+        return;
+    }
+
+    // Small subtrees are enumerated at once instead of recursing node by node
+    if (n - node <= TAIL_SIZE) {
+        tail(node, x_count, cut_weight, partition);
+        return;
+    }
+
+    // Try adding the node to subset X if it doesn't exceed the allowed size
+    if (x_count < a) {
+        partition[node] = 0;
+        dfs(node + 1, x_count + 1, cut_weight + delta_y, partition);
+    }
+
+    partition[node] = 1; // Assign the node to subset Y and continue the search
+    dfs(node + 1, x_count, cut_weight + delta_x, partition);
+}
+
+void CMinCut::tail(const int node, const int x_count, const int cut_weight, int *partition) {
+    const int remaining = n - node, x_left = a - x_count;
+    if (x_left < 0 || x_left > remaining)
+        return;
+
+    // Cost of each unassigned node towards the assigned ones, and the weights among the unassigned nodes
+    int cost_x[TAIL_LANES], cost_y[TAIL_LANES], degree[TAIL_LANES];
+    CTailVector rows[TAIL_LANES] = {};
+    int total = cut_weight; // Cut weight of the current mask, which starts with every unassigned node in Y
+    for (int u = 0; u < remaining; u++) {
+        cost_x[u] = cost_y[u] = degree[u] = 0;
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0)
+                cost_y[u] += weight(j, node + u); // Cut when u goes to Y
+            else
+                cost_x[u] += weight(j, node + u); // Cut when u goes to X
+        }
+        for (int v = 0; v < remaining; v++) {
+            if (v == u) continue;
+            rows[u][v] = weight(node + u, node + v);
+            degree[u] += rows[u][v];
+        }
+        total += cost_y[u];
+    }
+
+    // Walk all subsets in Gray code order, each step moves one node and updates every lane at once
+    CTailVector in_x = {}; // Weight from each unassigned node to the unassigned nodes in X
+    int mask = 0, count = 0;
+    for (int step = 0; step < 1 << remaining; step++) {
+        if (step > 0) {
+            const int u = __builtin_ctz(step);
+            mask ^= 1 << u;
+            if ((mask >> u) & 1) {
+                total += cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                in_x += rows[u];
+                count++;
+            } else {
+                in_x -= rows[u];
+                total -= cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                count--;
+            }
+        }
+        if (count == x_left && total <= min_cut_weight) {
+            for (int u = 0; u < remaining; u++) partition[node + u] = (mask >> u) & 1 ? 0 : 1;
+            record_partition(total, partition);
+        }
+    }
+}
+
+void CMinCut::record_partition(const int cut_weight, const int *partition) {
+    #pragma omp critical
+    {
+        if (cut_weight == min_cut_weight) {
+            best_partitions.emplace_back(partition, partition + n); // Store another optimal partition
+        } else if (cut_weight < min_cut_weight) {
+            min_cut_weight = cut_weight; // Update the best cut weight found
+            best_partitions.clear(); // Clear previous partitions
+            best_partitions.emplace_back(partition, partition + n); // Store the new best partition
+            if (options.on_incumbent) options.on_incumbent(cut_weight, best_partitions.back());
+        }
+    }
+}
+
+bool CMinCut::solve(CMinCutResult &result) {
+    result = CMinCutResult();
+    if (n < 1 || a < 0 || a > n || weights == nullptr) {
+        result.error = "Invalid size of the graph or of set X";
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (weight(i, j) < 0 || weight(i, j) != weight(j, i)) {
+                result.error = "Weights must be non-negative and symmetric";
+                return false;
+            }
+        }
+    }
+
+    const int threads = options.threads > 0 ? options.threads : omp_get_max_threads();
+    int *scratch = options.scratch;
+    vector<int> own_scratch;
+    if (scratch == nullptr) {
+        own_scratch.resize(scratch_size(n, threads));
+        scratch = own_scratch.data();
+    } else if (options.scratch_size < scratch_size(n, threads)) {
+        result.error = "Scratch buffer smaller than scratch_size()";
+        return false;
+    }
+
+    // Every assignment of the nodes [start, depth) is one starting prefix, node 0 stays in X if 2a == n
+    const int start = 2 * a == n ? 1 : 0;
+    int depth = start;
+    while (depth < n - TAIL_SIZE && (1LL << (depth - start)) < static_cast<long long>(threads) * STATES_PER_THREAD)
+        depth++;
+    const long long prefixes = 1LL << (depth - start);
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int *partition = scratch + static_cast<size_t>(omp_get_thread_num()) * n;
+        #pragma omp for schedule(dynamic)
+        for (long long prefix = 0; prefix < prefixes; prefix++) {
+            if (cancelled()) continue;
+            partition[0] = 0;
+            int x_count = start, cut_weight = 0;
+            for (int node = start; node < depth; node++) {
+                const int value = static_cast<int>((prefix >> (depth - 1 - node)) & 1); // X first, like dfs
+                for (int i = 0; i < node; i++)
+                    if (partition[i] != value) cut_weight += weight(i, node);
+                partition[node] = value;
+                x_count += value == 0 ? 1 : 0;
+            }
+            if (x_count <= a && a - x_count <= n - depth)
+                dfs(depth, x_count, cut_weight, partition);
+        }
+    }
+
+    sort(best_partitions.begin(), best_partitions.end()); // Threads find ties out of order
+    result.min_cut_weight = min_cut_weight;
+    result.partitions = move(best_partitions);
+    result.nodes = n_rec;
+    result.cancelled = stopped.load();
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+constexpr int TAIL_SIZE = 10; // Subtrees with at most this many unassigned nodes are enumerated by the tail kernel
+constexpr int TAIL_LANES = 16; // Vector width of the tail kernel, at least TAIL_SIZE
+constexpr int STATES_PER_THREAD = 16; // Starting prefixes per thread, enough to balance uneven subtrees
+
+typedef int CTailVector __attribute__((vector_size(4 * TAIL_LANES))); // One lane per unassigned node
+
+class CCancelToken {
+    atomic<bool> cancelled{false};
+
+public:
+    void cancel();
+
+    bool is_cancelled() const;
+};
+
+struct CMinCutOptions {
+    int threads = 0; // OpenMP threads, 0 for the OpenMP default
+    function<void(int, const vector<int> &)> on_incumbent; // Called with every strictly better cut and its partition
+    const CCancelToken *cancel = nullptr; // Stops the search, the best cut so far is returned
+    int *scratch = nullptr; // At least scratch_size(n, threads) ints, allocated internally if null
+    size_t scratch_size = 0; // Number of ints in scratch
+};
+
+struct CMinCutResult {
+    int min_cut_weight = 0; // Weight of the minimum cut
+    vector<vector<int> > partitions; // All optimal partitions, 0 for X and 1 for Y, node 0 in X if 2a == n
+    long long nodes = 0; // Search tree nodes visited
+    bool cancelled = false; // The search was stopped, the cut is the best found but not proven optimal
+    string error; // Reason when solve fails
+};
+
+class CMinCut {
+    const int n, a;
+    const int *weights; // Row-major n x n matrix owned by the caller
+    const CMinCutOptions &options;
+
+    int min_cut_weight; // Weight of the minimum cut
+    vector<vector<int> > best_partitions; // Best solutions
+    long long n_rec; // Number of recursions
+    atomic<bool> stopped; // The cancel token fired
+
+    int weight(int i, int j) const;
+
+    bool cancelled();
+
+    void dfs(int node, int x_count, int cut_weight, int *partition);
+
+    void tail(int node, int x_count, int cut_weight, int *partition);
+
+    void record_partition(int cut_weight, const int *partition);
+
+public:
+    CMinCut(int n, int a, const int *weights, const CMinCutOptions &options);
+
+    static size_t scratch_size(int n, int threads);
+
+    bool solve(CMinCutResult &result);
+};
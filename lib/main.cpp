@@ -0,0 +1,94 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "CFileReader.h"
+#include "mincut.h"
+
+using namespace std;
+using namespace chrono;
+
+// Reports every improvement, services would publish it instead of printing
+static void print_incumbent(const int weight, const int *, const int, void *) {
+    cerr << "Incumbent: " << weight << endl;
+}
+
+int main(const int argc, char *argv[]) {
+    // Optional --threads <k> and --timeout <seconds> before the positional arguments
+    int threads = 0, timeout = 0, arg = 1;
+    CFileReader file_reader;
+    while (arg + 1 < argc && (string(argv[arg]) == "--threads" || string(argv[arg]) == "--timeout")) {
+        if (!file_reader.readInteger(string(argv[arg]) == "--threads" ? threads : timeout, argv[arg + 1])) {
+            return 1;
+        }
+        arg += 2;
+    }
+    if (argc - arg != 2) {
+        cerr << "[--threads <k>] [--timeout <seconds>] <Size of set X = 'a'> <input_file>" << endl;
+        return 1;
+    }
+
+    // Start measuring execution time
+    const auto start_time = high_resolution_clock::now();
+
+    // Read the size of set X
+    int a;
+    if (!file_reader.readInteger(a, argv[arg])) {
+        return 1;
+    }
+
+    // Read the graph from the input file and flatten it into the row-major matrix of the library
+    int n;
+    vector<vector<int> > graph;
+    if (!file_reader.readFromFile(argv[arg + 1], graph, n)) {
+        return 1;
+    }
+    vector<int> weights;
+    for (const auto &row: graph) weights.insert(weights.end(), row.begin(), row.end());
+
+    mincut_cancel_token *token = mincut_cancel_token_create();
+    mincut_options options = {threads, print_incumbent, nullptr, token, nullptr, 0};
+
+    // The timeout cancels the search from another thread, as a service would on a deadline
+    bool done = false;
+    thread watchdog;
+    if (timeout > 0) {
+        watchdog = thread([&done, token, timeout] {
+            for (int i = 0; i < timeout * 100 && !__atomic_load_n(&done, __ATOMIC_RELAXED); i++)
+                this_thread::sleep_for(milliseconds(10));
+            mincut_cancel_token_cancel(token);
+        });
+    }
+
+    // Solve the problem
+    mincut_result result;
+    const int status = mincut_solve(n, a, weights.data(), &options, &result);
+    __atomic_store_n(&done, true, __ATOMIC_RELAXED);
+    if (watchdog.joinable()) watchdog.join();
+    mincut_cancel_token_destroy(token);
+    if (status < 0) {
+        cerr << "Error: mincut_solve failed with status " << status << endl;
+        return 1;
+    }
+
+    if (status == MINCUT_CANCELLED) cout << "Cancelled, the cut is not proven optimal" << endl;
+    cout << "Min Cut weight: " << result.weight << endl;
+    for (int k = 0; k < result.count; k++) {
+        const int *partition = result.partitions + static_cast<size_t>(k) * n;
+        cout << "X: ";
+        for (int j = 0; j < n; j++) if (partition[j] == 0) cout << j << " ";
+        cout << endl << "Y: ";
+        for (int j = 0; j < n; j++) if (partition[j] == 1) cout << j << " ";
+        cout << endl;
+    }
+    cout << "Recursion: " << result.nodes << endl;
+    mincut_result_free(&result);
+
+    // Measure and display execution time
+    const auto end_time = high_resolution_clock::now();
+    const duration<double> elapsed = end_time - start_time;
+    cout << "Time: " << elapsed.count() << " seconds" << endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "mincut.h"
+#include <cstdlib>
+#include <new>
+#include "CMinCut.h"
+
+struct mincut_cancel_token {
+    CCancelToken token;
+};
+
+mincut_cancel_token *mincut_cancel_token_create() {
+    return new(nothrow) mincut_cancel_token;
+}
+
+void mincut_cancel_token_cancel(mincut_cancel_token *token) {
+    if (token != nullptr) token->token.cancel();
+}
+
+void mincut_cancel_token_destroy(mincut_cancel_token *token) {
+    delete token;
+}
+
+size_t mincut_scratch_size(const int n, const int threads) {
+    return CMinCut::scratch_size(n, threads);
+}
+
+int mincut_solve(const int n, const int a, const int *weights, const mincut_options *options, mincut_result *result) {
+    if (result == nullptr) return MINCUT_INVALID_INPUT;
+    *result = mincut_result{0, n, 0, nullptr, 0};
+
+    CMinCutOptions cpp_options;
+    if (options != nullptr) {
+        cpp_options.threads = options->threads;
+        cpp_options.cancel = options->cancel != nullptr ? &options->cancel->token : nullptr;
+        cpp_options.scratch = options->scratch;
+        cpp_options.scratch_size = options->scratch_size;
+        if (options->on_incumbent != nullptr) {
+            const mincut_incumbent_fn on_incumbent = options->on_incumbent;
+            void *user = options->user;
+            cpp_options.on_incumbent = [on_incumbent, user, n](const int weight, const vector<int> &partition) {
+                on_incumbent(weight, partition.data(), n, user);
+            };
+        }
+        if (options->scratch != nullptr && options->scratch_size < CMinCut::scratch_size(n, options->threads))
+            return MINCUT_SCRATCH_TOO_SMALL;
+    }
+
+    // No exception may cross into C callers
+    try {
+        CMinCutResult cpp_result;
+        CMinCut solver(n, a, weights, cpp_options);
+        if (!solver.solve(cpp_result)) return MINCUT_INVALID_INPUT;
+
+        result->weight = cpp_result.min_cut_weight;
+        result->count = static_cast<int>(cpp_result.partitions.size());
+        result->nodes = cpp_result.nodes;
+        if (result->count > 0) {
+            result->partitions = static_cast<int *>(malloc(sizeof(int) * result->count * n));
+            if (result->partitions == nullptr) return MINCUT_OUT_OF_MEMORY;
+            for (int k = 0; k < result->count; k++)
+                for (int i = 0; i < n; i++)
+                    result->partitions[k * n + i] = cpp_result.partitions[k][i];
+        }
+        return cpp_result.cancelled ? MINCUT_CANCELLED : MINCUT_OK;
+    } catch (const bad_alloc &) {
+        return MINCUT_OUT_OF_MEMORY;
+    }
+}
+
+void mincut_result_free(mincut_result *result) {
+    if (result == nullptr) return;
+    free(result->partitions);
+    result->partitions = nullptr;
+    result->count = 0;
+}
@@ -0,0 +1,58 @@
+#ifndef MINCUT_H
+#define MINCUT_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    MINCUT_OK = 0,
+    MINCUT_CANCELLED = 1, /* Best cut found before the token fired, not proven optimal */
+    MINCUT_INVALID_INPUT = -1, /* Size, 'a' or weights out of range */
+    MINCUT_SCRATCH_TOO_SMALL = -2, /* Less than mincut_scratch_size() ints supplied */
+    MINCUT_OUT_OF_MEMORY = -3
+};
+
+typedef struct mincut_cancel_token mincut_cancel_token;
+
+/* Called with every strictly better cut, partition holds n entries (0 = X, 1 = Y) */
+typedef void (*mincut_incumbent_fn)(int weight, const int *partition, int n, void *user);
+
+typedef struct {
+    int threads; /* OpenMP threads, 0 for the OpenMP default */
+    mincut_incumbent_fn on_incumbent; /* Optional */
+    void *user; /* Passed to on_incumbent */
+    const mincut_cancel_token *cancel; /* Optional */
+    int *scratch; /* Optional, at least mincut_scratch_size() ints */
+    size_t scratch_size; /* Number of ints in scratch */
+} mincut_options;
+
+typedef struct {
+    int weight; /* Weight of the minimum cut, INT_MAX if cancelled before any cut was found */
+    int n; /* Number of nodes */
+    int count; /* Number of optimal partitions */
+    int *partitions; /* count * n entries, 0 = X, 1 = Y */
+    long long nodes; /* Search tree nodes visited */
+} mincut_result;
+
+mincut_cancel_token *mincut_cancel_token_create(void);
+
+void mincut_cancel_token_cancel(mincut_cancel_token *token);
+
+void mincut_cancel_token_destroy(mincut_cancel_token *token);
+
+size_t mincut_scratch_size(int n, int threads);
+
+/* Splits the n nodes into X with 'a' nodes and Y with the rest, minimizing the weight of the edges between them.
+   weights is a symmetric row-major n x n matrix, options may be NULL. */
+int mincut_solve(int n, int a, const int *weights, const mincut_options *options, mincut_result *result);
+
+void mincut_result_free(mincut_result *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -40,3 +40,25 @@ bool CFileReader::readFromFile(const string &filename, vector<vector<int> > &gra
     file.close();
     return true;
 }
+
+bool CFileReader::readFromFile(const string &filename, vector<vector<int> > &graph, CSparseGraph &sparse, int &n) {
+    if (!readFromFile(filename, graph, n)) {
+        return false;
+    }
+
+    // Build the compressed sparse row (CSR) adjacency from the dense matrix
+    sparse.offsets.assign(1, 0);
+    sparse.neighbours.clear();
+    sparse.weights.clear();
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j && graph[i][j] != 0) {
+                sparse.neighbours.push_back(j);
+                sparse.weights.push_back(graph[i][j]);
+            }
+        }
+        sparse.offsets.push_back(static_cast<int>(sparse.neighbours.size()));
+    }
+    sparse.density = n > 1 ? static_cast<double>(sparse.neighbours.size()) / (n * (n - 1.0)) : 1.0;
+    return true;
+}
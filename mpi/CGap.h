@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+
+using namespace std;
+
+// Allowed distance from the optimum, a node is pruned once its bound cannot beat the incumbent by more than that
+class CGap {
+    double relative; // Fraction of the optimum, from a value ending in %
+    int absolute; // Cut weight
+
+public:
+    CGap();
+
+    bool parse(const string &argv);
+
+    bool is_exact() const;
+
+    int limit(int incumbent) const;
+
+    double ratio(int cut_weight) const;
+};
@@ -2,7 +2,6 @@
 #include <algorithm>
 #include <iostream>
 #include <limits>
-#include <queue>
 #include <cmath>
 #include <map>
 #include <omp.h>
@@ -12,136 +11,162 @@ enum MPI_TAGS {
     STATE = 1,
     MIN_CUT = 2,
     TERMINATE = 3,
-    WAITING = 4,
-    RESULT = 5
+    WAITING = 4
 };
 
-CSolver::CSolver(const int n, const int a, const vector<vector<int> > &graph)
-    : n(n), a(a), graph(graph), min_cut_weight(numeric_limits<int>::max()) {
+CSolver::CSolver(const int n, const int a, const vector<vector<int> > &graph, const CSparseGraph &sparse)
+    : n(n), a(a), graph(graph), sparse(sparse), use_sparse(sparse.density < SPARSE_DENSITY),
+      min_cut_weight(numeric_limits<int>::max()), pending_report(false), next_report(0), task_depth(0),
+      n_rec(0), n_states(0) {
 }
 
-queue<CState> CSolver::starting_states(const int depth) const {
-    queue<CState> result;
-    queue<CState> q;
-
-    if (2 * a == n) {
-        CState new_state(1, 1, 0);
-        new_state.partition[0] = 0;
-        q.emplace(new_state);
-    } else {
-        CState new_state;
-        q.emplace(new_state);
-    }
-
-    while (!q.empty()) {
-        CState state = q.front();
-        q.pop();
-
-        if (state.node == depth) {
-            result.push(state);
-            continue;
-        }
-
-        const int node = state.node;
-
-        int delta_x = 0, delta_y = 0; // Contribution to cut weight when assigning node to X or Y
-        for (int i = 0; i < node; i++) {
-            if (state.partition[i] == 0)
-                delta_x += graph[i][node]; // Adding edges between node and subset X
-            else
-                delta_y += graph[i][node]; // Adding edges between node and subset Y
-        }
-
-        if (state.x_count < a) {
-            // Add the node to subset X
-            CState left = CState(node + 1, state.x_count + 1, state.cut_weight + delta_y, state.partition);
-            left.partition[node] = 0;
-            q.push(left);
-        }
+CFrontier CSolver::starting_states(const int depth) const {
+    // Expand whole levels at once, the frontier evaluates sibling states in batches
+    CFrontier states(n, a, graph);
+    while (states.get_depth() < min(depth, MASK_BITS))
+        states.expand(gap.limit(min_cut_weight));
+    return states;
+}
 
-        if (state.node - state.x_count < n - a) {
-            // Add the node to subset Y
-            CState right = CState(node + 1, state.x_count, state.cut_weight + delta_x, state.partition);
-            right.partition[node] = 1;
-            q.push(right);
-        }
+bool CSolver::next_state(const CFrontier &states, size_t &next, CState &state) const {
+    // States whose bound cannot beat the best cut reported so far, less the gap, never reach a slave
+    for (; next < states.size(); next++) {
+        if (states.cut_weight(next) + states.low_bound(next) > gap.limit(min_cut_weight)) continue;
+        state = CState(states.get_depth(), states.x_count(next), states.cut_weight(next), states.mask(next));
+        state.min_cut_weight = min_cut_weight;
+        next++;
+        return true;
     }
+    return false;
+}
 
-    return result;
+void CSolver::set_gap(const CGap &gap) {
+    this->gap = gap;
 }
 
 void CSolver::master(const int num_procs) {
-    queue<CState> states = starting_states(a - 1);
+    const CFrontier states = starting_states(a - 1);
+    size_t next = 0;
     const int num_slaves = num_procs - 1;
-    send_configurations(states, num_slaves);
+    const int started = send_configurations(states, next, num_slaves);
 
-    vector<int> results(num_slaves, 0); // num_results
-    int cut_weight;
-
-    int active_slaves = num_slaves;
+    // Slaves only report improvements of their best cut, tied partitions stay with them until the end
+    int active_slaves = started;
     while (active_slaves > 0) {
+        int cut_weight;
         MPI_Status status;
         MPI_Recv(&cut_weight, 1, MPI_INT, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
         const int slave_id = status.MPI_SOURCE;
+        min_cut_weight = min(min_cut_weight, cut_weight); // WAITING carries the best cut of the slave as well
 
-        if (status.MPI_TAG == MIN_CUT) {
-            if (cut_weight == min_cut_weight) {
-                results[slave_id - 1]++;
-            } else if (cut_weight < min_cut_weight) {
-                min_cut_weight = cut_weight;
-                results.clear();
-                results.resize(num_slaves, 0);
-                results[slave_id - 1]++;
-            }
-        } else if (status.MPI_TAG == WAITING) {
-            if (!states.empty()) {
-                CState next_state = states.front();
-                next_state.min_cut_weight = min_cut_weight;
-                MPI_Send(&next_state, sizeof(CState), MPI_BYTE, slave_id, STATE, MPI_COMM_WORLD);
-                states.pop();
+        if (status.MPI_TAG == WAITING) {
+            CState state;
+            if (next_state(states, next, state)) {
+                MPI_Send(&state, sizeof(CState), MPI_BYTE, slave_id, STATE, MPI_COMM_WORLD);
             } else {
+                MPI_Send(nullptr, 0, MPI_BYTE, slave_id, TERMINATE, MPI_COMM_WORLD);
                 active_slaves--;
             }
         }
     }
 
-    vector<vector<int> > result;
+    collect_results();
+}
+
+int CSolver::send_configurations(const CFrontier &states, size_t &next, const int num_slaves) {
+    int started = 0; // Slaves beyond the number of states have nothing to do
     for (int i = 1; i <= num_slaves; i++) {
-        const int num_results = results[i - 1];
-        if (num_results > 0) {
-            MPI_Send(nullptr, 0, MPI_BYTE, i, RESULT, MPI_COMM_WORLD);
-            vector<int> flat_buffer(num_results * n);
-            MPI_Recv(flat_buffer.data(), num_results * n, MPI_INT, i, RESULT, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            for (int j = 0; j < num_results; ++j) {
-                vector<int> partition(flat_buffer.begin() + j * n, flat_buffer.begin() + (j + 1) * n);
-                result.push_back(partition);
-            }
+        CState state;
+        if (next_state(states, next, state)) {
+            MPI_Send(&state, sizeof(CState), MPI_BYTE, i, STATE, MPI_COMM_WORLD);
+            started++;
         } else {
             MPI_Send(nullptr, 0, MPI_BYTE, i, TERMINATE, MPI_COMM_WORLD);
         }
     }
+    return started;
+}
+
+void CSolver::report_min_cut() {
+    // Improvements found in quick succession are coalesced into one message
+    const double now = MPI_Wtime();
+    if (now < next_report)
+        return;
+    next_report = now + REPORT_INTERVAL;
 
-    print_solution(min_cut_weight, result);
+    int cut_weight;
+#pragma omp critical
+    {
+        cut_weight = min_cut_weight;
+        pending_report.store(false, memory_order_relaxed);
+    }
+    MPI_Send(&cut_weight, 1, MPI_INT, 0, MIN_CUT, MPI_COMM_WORLD);
 }
 
-void CSolver::send_configurations(queue<CState> &states, const int num_slaves) {
-    for (int i = 1; i <= num_slaves; i++) {
-        CState state = states.front();
-        MPI_Send(&state, sizeof(CState), MPI_BYTE, i, STATE, MPI_COMM_WORLD);
-        states.pop();
+void CSolver::collect_results() {
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // Only the ranks holding the global minimum contribute their partitions, one bit per node
+    int global_min;
+    MPI_Allreduce(&min_cut_weight, &global_min, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    const int words = (n + 63) / 64;
+    vector<uint64_t> packed;
+    if (min_cut_weight == global_min) {
+        packed.assign(best_partitions.size() * words, 0);
+        for (size_t p = 0; p < best_partitions.size(); p++)
+            for (int i = 0; i < n; i++)
+                if (best_partitions[p][i] == 1) packed[p * words + i / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    const int count = static_cast<int>(packed.size());
+    vector<int> counts(rank == 0 ? num_procs : 0), displacements(rank == 0 ? num_procs : 0);
+    MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    vector<uint64_t> gathered;
+    if (rank == 0) {
+        for (int i = 1; i < num_procs; i++) displacements[i] = displacements[i - 1] + counts[i - 1];
+        gathered.resize(displacements.back() + counts.back());
     }
+    MPI_Gatherv(packed.data(), count, MPI_UINT64_T, gathered.data(), counts.data(), displacements.data(),
+                MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+    const long long local[2] = {n_rec, n_states};
+    long long totals[2] = {0, 0};
+    MPI_Reduce(local, totals, 2, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank != 0)
+        return;
+
+    vector<vector<int> > result(gathered.size() / words, vector<int>(n));
+    for (size_t p = 0; p < result.size(); p++)
+        for (int i = 0; i < n; i++)
+            result[p][i] = static_cast<int>((gathered[p * words + i / 64] >> (i % 64)) & 1);
+    sort(result.begin(), result.end());
+
+    print_solution(global_min, result);
+    cout << "Recursion: " << totals[0] << endl;
+    cout << "States: " << totals[1] << endl;
 }
 
 void CSolver::solve() {
+    // Spawn tasks only for the top levels of each state; deeper subtrees run sequentially in one task
+    int task_levels = TASK_SLACK;
+    for (int threads = omp_get_max_threads(); threads > 1; threads = (threads + 1) / 2)
+        task_levels++;
+
     CState state;
-    MPI_Recv(&state, sizeof(CState), MPI_BYTE, 0, STATE, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Status status;
+    MPI_Recv(&state, sizeof(CState), MPI_BYTE, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
 
-    while (true) {
-        vector<int> partition(state.partition, state.partition + n);
+    while (status.MPI_TAG == STATE) {
+        n_states++;
+        vector<int> partition(n, -1);
+        for (int i = 0; i < state.node; i++) partition[i] = static_cast<int>((state.mask >> i) & 1);
         if (min_cut_weight > state.min_cut_weight) {
             best_partitions.clear();
             min_cut_weight = state.min_cut_weight;
         }
+        task_depth = state.node + task_levels;
 
 #pragma omp parallel num_threads(omp_get_max_threads())
         {
@@ -151,77 +176,100 @@ void CSolver::solve() {
             }
         }
 
+        // Only the main thread talks to the master (MPI_THREAD_FUNNELED), the request for more work carries
+        // the best cut, so an improvement still held back by the rate limit goes with it
+        pending_report.store(false, memory_order_relaxed);
         MPI_Send(&min_cut_weight, 1, MPI_INT, 0, WAITING, MPI_COMM_WORLD);
-
-        MPI_Status status;
         MPI_Recv(&state, sizeof(CState), MPI_BYTE, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
-        if (status.MPI_TAG == TERMINATE) {
-            return;
-        } else if (status.MPI_TAG == RESULT) {
-            vector<int> flat_buffer;
-            const int num_results = static_cast<int>(best_partitions.size());
-            flat_buffer.reserve(num_results * n);
-            for (const auto &p: best_partitions) {
-                flat_buffer.insert(flat_buffer.end(), p.begin(), p.end());
-            }
-            MPI_Send(flat_buffer.data(), num_results * n, MPI_INT, 0, RESULT, MPI_COMM_WORLD);
-            return; // TERMINATE
-        }
     }
+
+    collect_results();
 }
 
 void CSolver::dfs(const int node, const int x_count, const int cut_weight, vector<int> &partition) {
-    // Prune the search if the current cut weight exceeds the best found so far
-    if (cut_weight > min_cut_weight)
+#pragma omp atomic update
+    n_rec++; // Atomically increment the recursion counter
+
+    // Prune the search if the current cut weight exceeds the best found so far, less the allowed gap
+    const int limit = gap.limit(min_cut_weight);
+    if (cut_weight > limit)
         return;
 
     // If all nodes are processed, check if a valid partition is found
     if (node == n) {
-        // Ensure the subset X has exactly 'a' elements
-        if (x_count == a) {
-#pragma omp critical
-            {
-                if (cut_weight == min_cut_weight) {
-                    best_partitions.push_back(partition); // Store another optimal partition
-                    // Send results back to the master
-                    MPI_Send(&min_cut_weight, 1, MPI_INT, 0, MIN_CUT, MPI_COMM_WORLD);
-                } else if (cut_weight < min_cut_weight) {
-                    min_cut_weight = cut_weight; // Update the best cut weight found
-                    best_partitions.clear(); // Clear previous partitions
-                    best_partitions.push_back(partition); // Store the new best partition
-                    // Send results back to the master
-                    MPI_Send(&min_cut_weight, 1, MPI_INT, 0, MIN_CUT, MPI_COMM_WORLD);
-                }
-            }
-        }
+        if (x_count == a) // Ensure the subset X has exactly 'a' elements
+            record_partition(cut_weight, partition);
         return;
     }
 
     int delta_x = 0, delta_y = 0; // Contribution to cut weight when assigning node to X or Y
-    for (int i = 0; i < node; i++) {
-        if (partition[i] == 0)
-            delta_x += graph[i][node]; // Adding edges between node and subset X
-        else
-            delta_y += graph[i][node]; // Adding edges between node and subset Y
-    }
-
     int low_bound_x = 0, low_bound_y = 0, low_bound = 0; // Compute a lower bound for future cut weight
-    for (int i = node; i < n; i++) {
-        for (int j = 0; j < node; j++) {
-            if (partition[j] == 0)
-                low_bound_x += graph[j][i];
+    if (use_sparse) {
+        // Neighbour lists are sorted, so only the neighbours already assigned are visited
+        const int *neighbours = sparse.neighbours.data(), *weights = sparse.weights.data();
+        for (int e = sparse.offsets[node]; e < sparse.offsets[node + 1] && neighbours[e] < node; e++) {
+            if (partition[neighbours[e]] == 0)
+                delta_x += weights[e]; // Adding edges between node and subset X
             else
-                low_bound_y += graph[j][i];
+                delta_y += weights[e]; // Adding edges between node and subset Y
+        }
+
+        for (int i = node; i < n; i++) {
+            for (int e = sparse.offsets[i]; e < sparse.offsets[i + 1] && neighbours[e] < node; e++) {
+                if (partition[neighbours[e]] == 0)
+                    low_bound_x += weights[e];
+                else
+                    low_bound_y += weights[e];
+            }
+            low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+            low_bound_x = 0, low_bound_y = 0;
+        }
+    } else {
+        for (int i = 0; i < node; i++) {
+            if (partition[i] == 0)
+                delta_x += graph[i][node]; // Adding edges between node and subset X
+            else
+                delta_y += graph[i][node]; // Adding edges between node and subset Y
+        }
+
+        for (int i = node; i < n; i++) {
+            for (int j = 0; j < node; j++) {
+                if (partition[j] == 0)
+                    low_bound_x += graph[j][i];
+                else
+                    low_bound_y += graph[j][i];
+            }
+            low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+            low_bound_x = 0, low_bound_y = 0;
         }
-        low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
-        low_bound_x = 0, low_bound_y = 0;
     }
 
     // Stop if the minimum possible future cut weight is already worse than the best found
-    if (low_bound + cut_weight > min_cut_weight) {
+    if (low_bound + cut_weight > limit) {
+        return;
+    }
+
+    // Small subtrees are enumerated at once instead of recursing node by node
+    if (n - node <= TAIL_SIZE) {
+        tail(node, x_count, cut_weight, partition);
+        return;
+    }
+
+    // Below the task depth this task owns its partition copy, so the subtree is searched in place
+    if (node >= task_depth) {
+        if (x_count < a) {
+            partition[node] = 0;
+            dfs(node + 1, x_count + 1, cut_weight + delta_y, partition);
+        }
+        partition[node] = 1;
+        dfs(node + 1, x_count, cut_weight + delta_x, partition);
         return;
     }
 
+    // Forward new results while the search is still running, but only from the main thread
+    if (pending_report.load(memory_order_relaxed) && omp_get_thread_num() == 0)
+        report_min_cut();
+
     // Try adding the node to subset X if it doesn't exceed the allowed size
     if (x_count < a) {
         partition[node] = 0;
@@ -234,8 +282,72 @@ void CSolver::dfs(const int node, const int x_count, const int cut_weight, vecto
     dfs(node + 1, x_count, cut_weight + delta_x, partition);
 }
 
+void CSolver::tail(const int node, const int x_count, const int cut_weight, vector<int> &partition) {
+    const int remaining = n - node, x_left = a - x_count;
+    if (x_left < 0 || x_left > remaining)
+        return;
+    // Cost of each unassigned node towards the assigned ones, and the weights among the unassigned nodes
+    int cost_x[TAIL_LANES], cost_y[TAIL_LANES], degree[TAIL_LANES];
+    CTailVector rows[TAIL_LANES] = {};
+    int total = cut_weight; // Cut weight of the current mask, which starts with every unassigned node in Y
+    for (int u = 0; u < remaining; u++) {
+        cost_x[u] = cost_y[u] = degree[u] = 0;
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0)
+                cost_y[u] += graph[j][node + u]; // Cut when u goes to Y
+            else
+                cost_x[u] += graph[j][node + u]; // Cut when u goes to X
+        }
+        for (int v = 0; v < remaining; v++) {
+            if (v == u) continue;
+            rows[u][v] = graph[node + u][node + v];
+            degree[u] += rows[u][v];
+        }
+        total += cost_y[u];
+    }
+
+    // Walk all subsets in Gray code order, each step moves one node and updates every lane at once
+    CTailVector in_x = {}; // Weight from each unassigned node to the unassigned nodes in X
+    int mask = 0, count = 0;
+    for (int step = 0; step < 1 << remaining; step++) {
+        if (step > 0) {
+            const int u = __builtin_ctz(step);
+            mask ^= 1 << u;
+            if ((mask >> u) & 1) {
+                total += cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                in_x += rows[u];
+                count++;
+            } else {
+                in_x -= rows[u];
+                total -= cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                count--;
+            }
+        }
+        if (count == x_left && total <= min_cut_weight) {
+            for (int u = 0; u < remaining; u++) partition[node + u] = (mask >> u) & 1 ? 0 : 1;
+            record_partition(total, partition);
+        }
+    }
+}
+
+void CSolver::record_partition(const int cut_weight, const vector<int> &partition) {
+#pragma omp critical
+    {
+        if (cut_weight == min_cut_weight) {
+            best_partitions.push_back(partition); // Store another optimal partition
+            // Ties stay with this slave until the results are gathered
+        } else if (cut_weight < min_cut_weight) {
+            min_cut_weight = cut_weight; // Update the best cut weight found
+            best_partitions.clear(); // Clear previous partitions
+            best_partitions.push_back(partition); // Store the new best partition
+            pending_report.store(true, memory_order_relaxed); // Reported to the master by the main thread
+        }
+    }
+}
+
 void CSolver::print_solution(const int cut_weight, const vector<vector<int> > &partition) const {
     cout << "Min Cut weight: " << cut_weight << endl;
+    if (!gap.is_exact()) cout << "Guaranteed ratio: " << gap.ratio(cut_weight) << endl;
     for (const auto &it: partition) {
         cout << "X: ";
         for (int j = 0; j < n; j++) if (it[j] == 0) cout << j << " ";
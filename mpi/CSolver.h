@@ -1,25 +1,57 @@
 #pragma once
-#include <queue>
+#include <atomic>
 #include <vector>
+#include "CFileReader.h"
+#include "CFrontier.h"
+#include "CGap.h"
 #include "CState.h"
 
 using namespace std;
 
+constexpr double SPARSE_DENSITY = 0.75; // Graphs below this density use the sparse kernels in dfs
+constexpr int TAIL_SIZE = 10; // Subtrees with at most this many unassigned nodes are enumerated by the tail kernel
+constexpr int TAIL_LANES = 16; // Vector width of the tail kernel, at least TAIL_SIZE
+
+typedef int CTailVector __attribute__((vector_size(4 * TAIL_LANES))); // One lane per unassigned node
+
+constexpr double REPORT_INTERVAL = 0.05; // Seconds between two reports of a better cut from one slave
+constexpr int TASK_SLACK = 3; // Extra task levels above log2(threads) to keep all threads busy
+
 class CSolver {
     const int n, a;
     const vector<vector<int> > graph;
+    const CSparseGraph sparse; // Same graph as neighbour lists
+    const bool use_sparse; // Iterate only over real neighbours in dfs
 
     int min_cut_weight; // Weight of the minimum cut
+    CGap gap; // Allowed distance from the optimum, exact by default
     vector<vector<int> > best_partitions; // Best solutions
+    atomic<bool> pending_report; // Best cut improved since the last report to the master
+    double next_report; // Time (MPI_Wtime) before which no further report is sent
+    int task_depth; // Nodes below this depth are searched sequentially by one thread
+    long long n_rec; // Number of recursions
+    long long n_states; // Number of states processed
 
 public:
-    CSolver(int n, int a, const vector<vector<int> > &graph);
+    CSolver(int n, int a, const vector<vector<int> > &graph, const CSparseGraph &sparse);
 
     void dfs(int node, int x_count, int cut_weight, vector<int> &partition);
 
-    queue<CState> starting_states(int depth) const;
+    void tail(int node, int x_count, int cut_weight, vector<int> &partition);
+
+    void record_partition(int cut_weight, const vector<int> &partition);
+
+    CFrontier starting_states(int depth) const;
+
+    bool next_state(const CFrontier &states, size_t &next, CState &state) const;
+
+    int send_configurations(const CFrontier &states, size_t &next, int num_slaves);
+
+    void report_min_cut();
+
+    void collect_results();
 
-    void send_configurations(queue<CState> &states, int num_slaves);
+    void set_gap(const CGap &gap);
 
     void master(int num_procs);
 
@@ -10,14 +10,18 @@ using namespace std;
 using namespace chrono;
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        cerr << "<Size of set X = 'a'> <input_file>" << endl;
+    if (argc != 3 && !(argc == 5 && string(argv[3]) == "--gap")) {
+        cerr << "<Size of set X = 'a'> <input_file> [--gap <weight | percent%>]" << endl;
         return 1;
     }
 
-    int my_rank, num_procs;
-    /* Initialize MPI */
-    MPI_Init(&argc, &argv);
+    int my_rank, num_procs, provided;
+    /* Initialize MPI, only the main thread of each process makes MPI calls */
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    if (provided < MPI_THREAD_FUNNELED) {
+        cerr << "MPI library does not support MPI_THREAD_FUNNELED" << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
     /* find out process rank */
     MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
     /* find out number of processes */
@@ -39,18 +43,27 @@ int main(int argc, char *argv[]) {
     // Read the graph from the input file
     int n;
     vector<vector<int> > graph;
-    if (!file_reader.readFromFile(argv[2], graph, n)) {
+    CSparseGraph sparse;
+    if (!file_reader.readFromFile(argv[2], graph, sparse, n)) {
+        return 1;
+    }
+
+    // Cut weight or percentage the result may be above the optimum
+    CGap gap;
+    if (argc == 5 && !gap.parse(argv[4])) {
         return 1;
     }
 
     // Master-Slave approach
     if (my_rank == 0) {
         // Master process generates initial configurations
-        CSolver solver(n, a, graph);
+        CSolver solver(n, a, graph, sparse);
+        solver.set_gap(gap);
         solver.master(num_procs);
     } else {
         // Slave processes receive configurations and perform DFS
-        CSolver solver(n, a, graph);
+        CSolver solver(n, a, graph, sparse);
+        solver.set_gap(gap);
         solver.solve();
     }
 
@@ -40,3 +40,64 @@ bool CFileReader::readFromFile(const string &filename, vector<vector<int> > &gra
     file.close();
     return true;
 }
+
+bool CFileReader::readFromFile(const string &filename, vector<vector<int> > &graph, CSparseGraph &sparse, int &n) {
+    if (!readFromFile(filename, graph, n)) {
+        return false;
+    }
+    buildSparse(graph, sparse);
+    return true;
+}
+
+bool CFileReader::readWeightChanges(const string &filename, const int n, vector<CWeightChange> &changes) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Could not open file: " << filename << endl;
+        return false;
+    }
+
+    // One change per line: both end nodes of the edge and its new weight
+    changes.clear();
+    CWeightChange change{};
+    while (file >> change.u >> change.v >> change.weight) {
+        if (change.u < 0 || change.u >= n || change.v < 0 || change.v >= n || change.u == change.v
+            || change.weight < 0) {
+            cerr << "Invalid weight change: " << change.u << " " << change.v << " " << change.weight << endl;
+            return false;
+        }
+        changes.push_back(change);
+    }
+    if (!file.eof()) {
+        cerr << "Invalid weight change file: " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+void CFileReader::applyWeightChanges(vector<vector<int> > &graph, CSparseGraph &sparse,
+                                     vector<CWeightChange> &changes) {
+    for (auto &change: changes) {
+        change.delta = change.weight - graph[change.u][change.v];
+        graph[change.u][change.v] = graph[change.v][change.u] = change.weight;
+    }
+    buildSparse(graph, sparse);
+}
+
+void CFileReader::buildSparse(const vector<vector<int> > &graph, CSparseGraph &sparse) {
+    const int n = static_cast<int>(graph.size());
+
+    // Build the compressed sparse row (CSR) adjacency from the dense matrix
+    sparse.offsets.assign(1, 0);
+    sparse.neighbours.clear();
+    sparse.weights.clear();
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j && graph[i][j] != 0) {
+                sparse.neighbours.push_back(j);
+                sparse.weights.push_back(graph[i][j]);
+            }
+        }
+        sparse.offsets.push_back(static_cast<int>(sparse.neighbours.size()));
+    }
+    sparse.density = n > 1 ? static_cast<double>(sparse.neighbours.size()) / (n * (n - 1.0)) : 1.0;
+}
@@ -4,9 +4,30 @@
 
 using namespace std;
 
+struct CSparseGraph {
+    vector<int> offsets; // Neighbours of node i are stored at [offsets[i], offsets[i + 1])
+    vector<int> neighbours; // Neighbour indices, sorted in increasing order for each node
+    vector<int> weights; // Edge weights matching the neighbours
+    double density = 0; // Fraction of non-zero entries off the diagonal
+};
+
+struct CWeightChange {
+    int u, v; // Edge whose weight changes
+    int weight; // New weight, 0 removes the edge
+    int delta = 0; // New weight minus the old one, filled in when the change is applied
+};
+
 class CFileReader {
 public:
     bool readInteger(int &i, const string &argv);
 
     bool readFromFile(const string &filename, vector<vector<int> > &graph, int &n);
+
+    bool readFromFile(const string &filename, vector<vector<int> > &graph, CSparseGraph &sparse, int &n);
+
+    bool readWeightChanges(const string &filename, int n, vector<CWeightChange> &changes);
+
+    void applyWeightChanges(vector<vector<int> > &graph, CSparseGraph &sparse, vector<CWeightChange> &changes);
+
+    void buildSparse(const vector<vector<int> > &graph, CSparseGraph &sparse);
 };
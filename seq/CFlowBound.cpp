@@ -0,0 +1,119 @@
+#include "CFlowBound.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+using namespace chrono;
+
+CFlowBound::CFlowBound(const int n, const vector<vector<int> > &graph)
+    : n(n), graph(graph), source(n), sink(n + 1), flows(n + 1, vector<int>((n + 2) * (n + 2), 0)),
+      ready(n + 1, false), cap_source(n + 2, 0), cap_sink(n + 2, 0), level(n + 2), next_arc(n + 2),
+      evaluations(0), prunes(0), seconds(0) {
+}
+
+void CFlowBound::reset() {
+    fill(ready.begin(), ready.end(), false);
+}
+
+int CFlowBound::capacity(const int u, const int v) const {
+    if (u == source || u == sink) {
+        if (v == source || v == sink) return 0; // Edges between assigned nodes are already in the cut
+        return u == source ? cap_source[v] : cap_sink[v];
+    }
+    if (v == source) return cap_source[u];
+    if (v == sink) return cap_sink[u];
+    return graph[u][v];
+}
+
+bool CFlowBound::build_levels(const int *flow) {
+    const int size = n + 2;
+    fill(level.begin(), level.end(), -1);
+    vector<int> queue{source};
+    level[source] = 0;
+    for (size_t head = 0; head < queue.size(); head++) {
+        const int u = queue[head];
+        for (const int v: active) {
+            if (level[v] == -1 && capacity(u, v) - flow[u * size + v] > 0) {
+                level[v] = level[u] + 1;
+                queue.push_back(v);
+            }
+        }
+    }
+    return level[sink] != -1;
+}
+
+int CFlowBound::augment(int *flow, const int u, const int pushed) {
+    if (u == sink) return pushed;
+    const int size = n + 2;
+    for (int &i = next_arc[u]; i < static_cast<int>(active.size()); i++) {
+        const int v = active[i];
+        const int residual = capacity(u, v) - flow[u * size + v];
+        if (level[v] != level[u] + 1 || residual <= 0) continue;
+        const int sent = augment(flow, v, min(pushed, residual));
+        if (sent > 0) {
+            flow[u * size + v] += sent;
+            flow[v * size + u] -= sent;
+            return sent;
+        }
+    }
+    return 0;
+}
+
+int CFlowBound::bound(const int node, const vector<int> &partition) {
+    const auto start_time = high_resolution_clock::now();
+    evaluations++;
+    const int size = n + 2;
+
+    // Capacities of the contracted network: fixed X nodes form the source, fixed Y nodes the sink
+    active.clear();
+    for (int u = node; u < n; u++) {
+        cap_source[u] = cap_sink[u] = 0;
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0) cap_source[u] += graph[j][u];
+            else cap_sink[u] += graph[j][u];
+        }
+        active.push_back(u);
+    }
+    active.push_back(source);
+    active.push_back(sink);
+
+    // Warm start from the parent flow, which stays feasible once the last assigned node is merged into its side
+    vector<int> &flow = flows[node];
+    if (node > 0 && ready[node - 1]) {
+        flow = flows[node - 1];
+        const int v = node - 1;
+        const int side = partition[v] == 0 ? source : sink;
+        for (int u = node; u < n; u++) {
+            flow[side * size + u] += flow[v * size + u];
+            flow[u * size + side] = -flow[side * size + u];
+        }
+        for (int u = 0; u < size; u++) flow[v * size + u] = flow[u * size + v] = 0;
+        flow[source * size + sink] = flow[sink * size + source] = 0;
+    } else {
+        fill(flow.begin(), flow.end(), 0);
+    }
+    ready[node] = true;
+
+    // Dinic's algorithm from the warm start
+    while (build_levels(flow.data())) {
+        fill(next_arc.begin(), next_arc.end(), 0);
+        while (augment(flow.data(), source, numeric_limits<int>::max()) > 0) {
+        }
+    }
+
+    int value = 0; // Net flow out of the source
+    for (int u = node; u < n; u++) value += flow[source * size + u];
+
+    const duration<double> elapsed = high_resolution_clock::now() - start_time;
+    seconds += elapsed.count();
+    return value;
+}
+
+void CFlowBound::count_prune() {
+    prunes++;
+}
+
+void CFlowBound::print_stats() const {
+    cout << "Flow bound: " << evaluations << " evaluations, " << prunes << " prunes, " << seconds << " seconds" << endl;
+}
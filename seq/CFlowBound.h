@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+class CFlowBound {
+    const int n;
+    const vector<vector<int> > &graph;
+    const int source, sink; // Contracted X and Y nodes
+
+    vector<vector<int> > flows; // Flow matrix of the network at each depth, reused by the children
+    vector<bool> ready; // The flow at this depth belongs to the parent of the current node
+    vector<int> cap_source, cap_sink; // Capacities from the contracted nodes to each unassigned node
+    vector<int> active; // Unassigned nodes plus source and sink
+    vector<int> level, next_arc; // Dinic level graph and current arc
+
+    long long evaluations; // Number of computed flows
+    long long prunes; // Number of nodes pruned by the flow bound
+    double seconds; // Time spent computing flows
+
+    int capacity(int u, int v) const;
+
+    bool build_levels(const int *flow);
+
+    int augment(int *flow, int u, int pushed);
+
+public:
+    CFlowBound(int n, const vector<vector<int> > &graph);
+
+    void reset();
+
+    int bound(int node, const vector<int> &partition);
+
+    void count_prune();
+
+    void print_stats() const;
+};
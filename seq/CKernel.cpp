@@ -0,0 +1,123 @@
+#include "CKernel.h"
+#include <algorithm>
+
+CKernel::CKernel(const int n, const int a, const vector<vector<int> > &graph, const bool enabled)
+    : n(n), a(a), isolated(0), twin_prev(n, -1), twin_count(0) {
+    if (!enabled) {
+        for (int v = 0; v < n; v++) {
+            order.push_back(v);
+            classes.push_back({v});
+        }
+        return;
+    }
+
+    // Isolated nodes never add to the cut, only their number in X matters
+    vector<int> isolated_nodes;
+    for (int v = 0; v < n; v++) {
+        if (count(graph[v].begin(), graph[v].end(), 0) == n) isolated_nodes.push_back(v);
+        else order.push_back(v);
+    }
+    isolated = static_cast<int>(isolated_nodes.size());
+
+    // Twins have the same edge weights to every other node, so swapping them keeps the cut weight
+    const int search_n = n - isolated;
+    vector<int> head_class(search_n, -1); // Class of each node that starts a twin class
+    for (int i = 0; i < search_n; i++) {
+        for (int j = 0; j < i; j++) {
+            if (head_class[j] == -1) continue;
+            const int u = order[i], v = order[j];
+            bool twin = true;
+            for (int w = 0; w < n && twin; w++)
+                if (w != u && w != v && graph[u][w] != graph[v][w]) twin = false;
+            if (twin) {
+                twin_prev[i] = classes[head_class[j]].back();
+                classes[head_class[j]].push_back(i);
+                twin_count++;
+                break;
+            }
+        }
+        if (twin_prev[i] == -1) {
+            head_class[i] = static_cast<int>(classes.size());
+            classes.push_back({i});
+        }
+    }
+
+    order.insert(order.end(), isolated_nodes.begin(), isolated_nodes.end());
+    if (isolated > 0) {
+        classes.emplace_back();
+        for (int i = search_n; i < n; i++) classes.back().push_back(i);
+    }
+}
+
+vector<vector<int> > CKernel::reduce(const vector<vector<int> > &graph) const {
+    vector<vector<int> > reduced(n, vector<int>(n));
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            reduced[i][j] = graph[order[i]][order[j]];
+    return reduced;
+}
+
+CSparseGraph CKernel::reduce(const CSparseGraph &sparse, const vector<vector<int> > &reduced) const {
+    if (isolated == 0) return sparse; // Twins keep their positions, so the node order is unchanged
+    CSparseGraph result;
+    CFileReader().buildSparse(reduced, result);
+    return result;
+}
+
+int CKernel::search_size() const {
+    return n - isolated;
+}
+
+int CKernel::min_x_count() const {
+    return max(0, a - isolated); // The isolated nodes fill up the rest of X
+}
+
+int CKernel::get_twin_prev(const int node) const {
+    return twin_prev[node];
+}
+
+int CKernel::eliminated() const {
+    return isolated;
+}
+
+int CKernel::twins() const {
+    return twin_count;
+}
+
+vector<vector<int> > CKernel::lift(const vector<vector<int> > &partitions) const {
+    // Every solution stands for all solutions with the same number of X nodes in each twin class
+    vector<vector<int> > lifted;
+    vector<int> partition(n);
+    for (const auto &reduced: partitions) {
+        vector<int> counts(classes.size(), 0);
+        int x_count = 0;
+        for (size_t c = 0; c < classes.size(); c++)
+            for (const int v: classes[c])
+                if (reduced[v] == 0) counts[c]++, x_count++;
+        if (isolated > 0 && reduced[classes.back()[0]] == -1) counts.back() = a - x_count; // Left out of the search
+        expand(counts, 0, partition, lifted);
+    }
+    sort(lifted.begin(), lifted.end());
+    lifted.erase(unique(lifted.begin(), lifted.end()), lifted.end());
+    return lifted;
+}
+
+void CKernel::expand(const vector<int> &counts, const size_t index, vector<int> &partition,
+                     vector<vector<int> > &lifted) const {
+    if (index == classes.size()) {
+        vector<int> original(n);
+        for (int i = 0; i < n; i++) original[order[i]] = partition[i];
+        if (2 * a == n && original[0] == 1) // Same convention as the search, node 0 in X
+            for (auto &value: original) value ^= 1;
+        lifted.push_back(original);
+        return;
+    }
+
+    const vector<int> &members = classes[index];
+    vector<int> sides(members.size(), 1);
+    fill(sides.begin(), sides.begin() + counts[index], 0);
+    do {
+        for (size_t i = 0; i < members.size(); i++) partition[members[i]] = sides[i];
+        expand(counts, index + 1, partition, lifted);
+    } while (next_permutation(sides.begin(), sides.end()));
+}
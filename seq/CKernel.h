@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include "CFileReader.h"
+
+using namespace std;
+
+class CKernel {
+    const int n, a;
+    vector<int> order; // Original node at each position of the reduced graph
+    int isolated; // Nodes without edges, placed last and left out of the search
+    vector<int> twin_prev; // Previous node with the same weighted neighbourhood, or -1
+    int twin_count; // Nodes that have a previous twin
+    vector<vector<int> > classes; // Twin classes, the isolated nodes form one of them
+
+    void expand(const vector<int> &counts, size_t index, vector<int> &partition,
+                vector<vector<int> > &lifted) const;
+
+public:
+    CKernel(int n, int a, const vector<vector<int> > &graph, bool enabled);
+
+    vector<vector<int> > reduce(const vector<vector<int> > &graph) const;
+
+    CSparseGraph reduce(const CSparseGraph &sparse, const vector<vector<int> > &reduced) const;
+
+    int search_size() const;
+
+    int min_x_count() const;
+
+    int get_twin_prev(int node) const;
+
+    int eliminated() const;
+
+    int twins() const;
+
+    vector<vector<int> > lift(const vector<vector<int> > &partitions) const;
+};
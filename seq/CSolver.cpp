@@ -1,89 +1,353 @@
 #include "CSolver.h"
+#include "CTreeDecomposition.h"
 #include <algorithm>
 #include <iostream>
 #include <limits>
 
 long long n_rec = 0; // Number of recursions
 
-CSolver::CSolver(const int n, const int a, const vector<vector<int> > &graph)
-    : n(n), a(a), graph(graph), min_cut_weight(numeric_limits<int>::max()), partition(n, -1) {
+CSolver::CSolver(const int n, const int a, const vector<vector<int> > &graph, const CSparseGraph &sparse,
+                 const int spectral_depth, const int flow_depth, const bool reduce)
+    : n(n), a(a), kernel(n, a, graph, reduce), graph(kernel.reduce(graph)),
+      sparse(kernel.reduce(sparse, this->graph)), n_search(kernel.search_size()), x_min(kernel.min_x_count()),
+      use_sparse(this->sparse.density < SPARSE_DENSITY), min_cut_weight(numeric_limits<int>::max()), partition(n, -1),
+      tree_width(-1), spectral_depth(spectral_depth), spectral(n, this->graph, max(0, spectral_depth)),
+      root_bound(0), proven(false), flow_depth(flow_depth), flow(n, this->graph),
+      warm_bound(0), warm_skipped(false), keep_proof(false), progress_nodes(0) {
 }
 
-void CSolver::dfs(const int node, const int x_count, const int cut_weight) {
+int CSolver::dfs(const int node, const int x_count, const int cut_weight, const int warm_node,
+                 const int warm_low_bound) {
     n_rec++; // Increment recursion counter
+    if (progress_nodes > 0 && (n_rec & 0xFFFF) == 0)
+        report_progress();
 
-    // Prune the search if the current cut weight exceeds the best found so far
-    if (cut_weight > min_cut_weight)
-        return;
+    // Stop the whole search once the best cut is known to be optimal
+    if (proven)
+        return root_bound;
+
+    // Prune the search if the current cut weight exceeds the best found so far, less the allowed gap
+    if (cut_weight > gap.limit(min_cut_weight))
+        return cut_weight;
 
     // If all nodes are processed, check if a valid partition is found
-    if (node == n) {
-        if (x_count == a) {
-            // Ensure the subset X has exactly 'a' elements
-            if (cut_weight == min_cut_weight) {
-                best_partitions.push_back(partition); // Store another optimal partition
-            } else {
-                min_cut_weight = cut_weight; // Update the best cut weight found
-                best_partitions.clear(); // Clear previous partitions
-                best_partitions.push_back(partition); // Store the new best partition
+    if (node == n_search) {
+        if (x_count < x_min) // Ensure the subset X can have exactly 'a' elements
+            return numeric_limits<int>::max();
+        record_partition(cut_weight);
+        return cut_weight;
+    }
+
+    // After a warm start every cut is at least its bound from the previous search plus the changes it crosses
+    if (warm.min_cut_weight >= 0) {
+        if (warm_low_bound == numeric_limits<int>::max())
+            return warm_low_bound; // The subtree has no partition with |X| = a
+        const int warm_bound = warm_low_bound + change_bound(node);
+        if (warm_bound > min_cut_weight)
+            return warm_bound;
+    }
+
+    int delta_x = 0, delta_y = 0; // Contribution to cut weight when assigning node to X or Y
+    int low_bound_x = 0, low_bound_y = 0, low_bound = 0; // Compute a lower bound for future cut weight
+    if (use_sparse) {
+        // Neighbour lists are sorted, so only the neighbours already assigned are visited
+        const int *neighbours = sparse.neighbours.data(), *weights = sparse.weights.data();
+        for (int e = sparse.offsets[node]; e < sparse.offsets[node + 1] && neighbours[e] < node; e++) {
+            if (partition[neighbours[e]] == 0)
+                delta_x += weights[e]; // Adding edges between node and subset X
+            else
+                delta_y += weights[e]; // Adding edges between node and subset Y
+        }
+
+        for (int i = node; i < n_search; i++) {
+            for (int e = sparse.offsets[i]; e < sparse.offsets[i + 1] && neighbours[e] < node; e++) {
+                if (partition[neighbours[e]] == 0)
+                    low_bound_x += weights[e];
+                else
+                    low_bound_y += weights[e];
             }
+            low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+            low_bound_x = 0, low_bound_y = 0;
+        }
+    } else {
+        for (int i = 0; i < node; i++) {
+            if (partition[i] == 0)
+                delta_x += graph[i][node]; // Adding edges between node and subset X
+            else
+                delta_y += graph[i][node]; // Adding edges between node and subset Y
+        }
+
+        for (int i = node; i < n_search; i++) {
+            for (int j = 0; j < node; j++) {
+                if (partition[j] == 0)
+                    low_bound_x += graph[j][i];
+                else
+                    low_bound_y += graph[j][i];
+            }
+            low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+            low_bound_x = 0, low_bound_y = 0;
         }
-        return;
     }
 
-    int delta_x = 0, delta_y = 0; // Contribution to cut weight when assigning node to X or Y
-    for (int i = 0; i < node; i++) {
-        if (partition[i] == 0)
-            delta_x += graph[i][node]; // Adding edges between node and subset X
-        else
-            delta_y += graph[i][node]; // Adding edges between node and subset Y
+    // Edges among the unassigned nodes are bounded separately, which pays off only near the root
+    if (node <= spectral_depth)
+        low_bound += spectral.bound(node, a - x_count);
+
+    // Stop if the minimum possible future cut weight is already worse than the best found
+    if (low_bound + cut_weight > gap.limit(min_cut_weight)) {
+        return low_bound + cut_weight;
     }
 
-    int low_bound_x = 0, low_bound_y = 0, low_bound = 0; // Compute a lower bound for future cut weight
-    for (int i = node; i < n; i++) {
+    // The minimum cut separating the assigned X and Y nodes is stronger, but only cheap enough near the root
+    if (node <= flow_depth) {
+        const int flow_bound = flow.bound(node, partition) + cut_weight;
+        if (flow_bound > gap.limit(min_cut_weight)) {
+            flow.count_prune();
+            return flow_bound;
+        }
+    }
+
+    // Small subtrees are enumerated at once instead of recursing node by node
+    if (n_search - node <= TAIL_SIZE) {
+        return tail(node, x_count, cut_weight);
+    }
+
+    // Keep the bound of this subtree for a later warm start, the children link themselves below
+    const int proof_node = keep_proof && proof.size() < PROOF_NODES ? static_cast<int>(proof.size()) : -1;
+    if (proof_node != -1) proof.push_back({{numeric_limits<int>::max(), numeric_limits<int>::max()}, {-1, -1}});
+
+    // Try adding the node to subset X if it doesn't exceed the allowed size, then to subset Y
+    int bound = numeric_limits<int>::max(); // Smallest bound over both subtrees
+    for (int value = 0; value < 2; value++) {
+        if (value == 0 && x_count == a) continue;
+        const int twin = kernel.get_twin_prev(node);
+        if (value == 0 && twin != -1 && partition[twin] == 1) continue; // Twins enter X in order
+        partition[node] = value;
+        const int child = static_cast<int>(proof.size());
+        const int child_bound = dfs(node + 1, x_count + 1 - value, cut_weight + (value == 0 ? delta_y : delta_x),
+                                    warm_node >= 0 ? warm.proof[warm_node].child[value] : -1,
+                                    warm_node >= 0 ? warm.proof[warm_node].bound[value] : warm_low_bound);
+        bound = min(bound, child_bound);
+        if (proof_node != -1) {
+            proof[proof_node].bound[value] = child_bound;
+            if (static_cast<int>(proof.size()) > child) proof[proof_node].child[value] = child;
+        }
+    }
+    return bound;
+}
+
+int CSolver::tail(const int node, const int x_count, const int cut_weight) {
+    const int remaining = n_search - node, x_low = max(0, x_min - x_count), x_high = a - x_count;
+    if (x_high < 0 || x_low > remaining)
+        return numeric_limits<int>::max();
+
+    // Unassigned nodes that may go to X only after their twin
+    int blocked = 0, twin_bit[TAIL_LANES];
+    for (int u = 0; u < remaining; u++) {
+        const int twin = kernel.get_twin_prev(node + u);
+        twin_bit[u] = twin >= node ? twin - node : -1;
+        if (twin != -1 && twin < node && partition[twin] == 1) blocked |= 1 << u;
+    }
+
+    // Cost of each unassigned node towards the assigned ones, and the weights among the unassigned nodes
+    int cost_x[TAIL_LANES], cost_y[TAIL_LANES], degree[TAIL_LANES];
+    CTailVector rows[TAIL_LANES] = {};
+    int total = cut_weight; // Cut weight of the current mask, which starts with every unassigned node in Y
+    for (int u = 0; u < remaining; u++) {
+        cost_x[u] = cost_y[u] = degree[u] = 0;
         for (int j = 0; j < node; j++) {
             if (partition[j] == 0)
-                low_bound_x += graph[j][i];
+                cost_y[u] += graph[j][node + u]; // Cut when u goes to Y
             else
-                low_bound_y += graph[j][i];
+                cost_x[u] += graph[j][node + u]; // Cut when u goes to X
         }
-        low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
-        low_bound_x = 0, low_bound_y = 0;
+        for (int v = 0; v < remaining; v++) {
+            if (v == u) continue;
+            rows[u][v] = graph[node + u][node + v];
+            degree[u] += rows[u][v];
+        }
+        total += cost_y[u];
     }
 
-    // Stop if the minimum possible future cut weight is already worse than the best found
-    if (low_bound + cut_weight > min_cut_weight) {
-        return;
+    // Walk all subsets in Gray code order, each step moves one node and updates every lane at once
+    CTailVector in_x = {}; // Weight from each unassigned node to the unassigned nodes in X
+    int mask = 0, count = 0, best = numeric_limits<int>::max();
+    for (int step = 0; step < 1 << remaining && !proven; step++) {
+        if (step > 0) {
+            const int u = __builtin_ctz(step);
+            mask ^= 1 << u;
+            if ((mask >> u) & 1) {
+                total += cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                in_x += rows[u];
+                count++;
+            } else {
+                in_x -= rows[u];
+                total -= cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                count--;
+            }
+        }
+        if (count >= x_low && count <= x_high) {
+            best = min(best, total);
+            bool ordered = total <= min_cut_weight && (mask & blocked) == 0;
+            for (int u = 0; u < remaining && ordered && kernel.twins() > 0; u++)
+                if (twin_bit[u] != -1 && (mask >> u) & 1 && !((mask >> twin_bit[u]) & 1)) ordered = false;
+            if (ordered) {
+                for (int u = 0; u < remaining; u++) partition[node + u] = (mask >> u) & 1 ? 0 : 1;
+                record_partition(total);
+            }
+        }
+    }
+    return proven ? root_bound : best;
+}
+
+void CSolver::record_partition(const int cut_weight) {
+    if (cut_weight == min_cut_weight) {
+        best_partitions.push_back(partition); // Store another optimal partition
+    } else {
+        min_cut_weight = cut_weight; // Update the best cut weight found
+        best_partitions.clear(); // Clear previous partitions
+        best_partitions.push_back(partition); // Store the new best partition
+        // Every optimum is listed, so reaching the bound does not end an exact search, only a cut within the
+        // gap of it does, as the remaining cuts can no longer beat the limit
+        proven = gap.limit(min_cut_weight) < root_bound;
     }
+}
 
-    // Try adding the node to subset X if it doesn't exceed the allowed size
-    if (x_count < a) {
-        partition[node] = 0;
-        dfs(node + 1, x_count + 1, cut_weight + delta_y);
+int CSolver::change_bound(const int node) const {
+    // Changes between assigned nodes are known, the others count only if they can lower the cut
+    int bound = 0;
+    for (const auto &change: warm.changes) {
+        if (change.u < node && change.v < node) {
+            if (partition[change.u] != partition[change.v]) bound += change.delta;
+        } else {
+            bound += min(0, change.delta);
+        }
     }
+    return bound;
+}
+
+void CSolver::record_proof() {
+    keep_proof = true;
+}
 
-    partition[node] = 1; // Assign the node to subset Y and continue the search
-    dfs(node + 1, x_count, cut_weight + delta_x);
+void CSolver::warm_start(CWarmStart previous, const vector<CWeightChange> &changes) {
+    warm = move(previous);
+    warm.changes.insert(warm.changes.end(), changes.begin(), changes.end());
+    keep_proof = true;
+}
+
+CWarmStart CSolver::get_warm_start() {
+    CWarmStart next;
+    next.min_cut_weight = min_cut_weight;
+    next.best_partitions = kernel.lift(best_partitions);
+    next.base_weight = min_cut_weight;
+    if (warm_skipped) {
+        // Nothing was searched, so the previous proof stays valid together with all changes since
+        next.proof = move(warm.proof);
+        next.base_weight = warm.base_weight;
+        next.changes = move(warm.changes);
+    } else if (tree_width == -1) {
+        next.proof = move(proof);
+    }
+    return next;
+}
+
+bool CSolver::start_warm() {
+    // The previous optima under the new weights give the incumbent
+    int incumbent = numeric_limits<int>::max();
+    vector<vector<int> > incumbents;
+    for (const auto &old: warm.best_partitions) {
+        int cut = 0;
+        for (int i = 0; i < n; i++)
+            for (int j = i + 1; j < n; j++)
+                if (old[i] != old[j]) cut += graph[i][j];
+        if (cut < incumbent) incumbents.clear();
+        if (cut <= incumbent) {
+            incumbent = cut;
+            incumbents.push_back(old);
+        }
+    }
+    min_cut_weight = incumbent; // dfs finds the partitions of this weight again, with any other ties
+
+    // No cut can drop below the proven optimum by more than the total decrease, and a cut that reaches
+    // this bound was optimal at every solve since, so the incumbents are then exactly all new optima
+    warm_bound = warm.base_weight;
+    for (const auto &change: warm.changes) warm_bound += min(0, change.delta);
+    if (incumbent <= warm_bound) {
+        best_partitions = incumbents;
+        warm_skipped = true;
+    }
+    return warm_skipped;
+}
+
+void CSolver::show_progress(const double estimated_nodes) {
+    progress_nodes = estimated_nodes;
+    progress_start = progress_last = chrono::steady_clock::now();
+}
+
+void CSolver::set_gap(const CGap &gap) {
+    this->gap = gap;
+}
+
+void CSolver::report_progress() {
+    const auto now = chrono::steady_clock::now();
+    if (now - progress_last < chrono::seconds(1)) return;
+    progress_last = now;
+
+    // The estimate can be off by a lot, so the fraction is capped and the ETA follows the current rate
+    const double elapsed = chrono::duration<double>(now - progress_start).count();
+    const double fraction = min(0.99, n_rec / progress_nodes);
+    cerr << "\rProgress: " << static_cast<int>(100 * fraction) << " %, ETA " << static_cast<int>(
+        elapsed / fraction - elapsed) << " s   " << flush;
 }
 
 void CSolver::solve() {
-    if (2 * a == n) {
-        partition[0] = 0; // If X and Y must be equal in size, placing the first node in X avoids duplicate results
-        dfs(1, 1, 0); // Start DFS with one node already in X
-    } else {
-        dfs(0, 0, 0); // Otherwise, start DFS normally from the beginning
+    n_rec = 0;
+
+    // Sparse graphs with a narrow tree decomposition are solved exactly by dynamic programming
+    CTreeDecomposition decomposition(n, a, graph);
+    if (decomposition.is_narrow()) {
+        tree_width = decomposition.get_width();
+        min_cut_weight = decomposition.solve(best_partitions);
+    } else if (warm.min_cut_weight < 0 || !start_warm()) {
+        root_bound = spectral.bound(0, a); // With a gap the search stops as soon as it is met
+        flow.reset();
+        if (2 * a == n) {
+            // If X and Y must be equal in size, placing the first node in X avoids duplicate results
+            partition[0] = 0;
+            dfs(1, 1, 0, warm.proof.empty() ? -1 : 0, warm.base_weight); // Start DFS with one node already in X
+        } else {
+            // Otherwise, start DFS normally from the beginning
+            dfs(0, 0, 0, warm.proof.empty() ? -1 : 0, warm.base_weight);
+        }
+        sort(best_partitions.begin(), best_partitions.end()); // The tail kernel finds ties out of order
     }
+    if (progress_nodes > 0) cerr << endl;
     print_solution();
 }
 
 void CSolver::print_solution() const {
     cout << "Min Cut weight: " << min_cut_weight << endl;
-    for (const auto &it: best_partitions) {
+    if (!gap.is_exact()) // Dynamic programming is always exact
+        cout << "Guaranteed ratio: " << (tree_width != -1 ? 1.0 : gap.ratio(min_cut_weight)) << endl;
+    for (const auto &it: kernel.lift(best_partitions)) {
         cout << "X: ";
         for (int j = 0; j < n; j++) if (it[j] == 0) cout << j << " ";
         cout << endl << "Y: ";
         for (int j = 0; j < n; j++) if (it[j] == 1) cout << j << " ";
         cout << endl;
     }
+    if (tree_width != -1) {
+        cout << "Tree width: " << tree_width << endl;
+    } else if (warm_skipped) {
+        cout << "Warm start bound: " << warm_bound << " (reached, search skipped)" << endl;
+    } else {
+        if (warm.min_cut_weight >= 0) cout << "Warm start bound: " << warm_bound << endl;
+        cout << "Lower bound: " << root_bound << (proven ? " (reached, search stopped early)"
+                                                   : min_cut_weight <= root_bound ? " (reached)" : "") << endl;
+    }
+    if (flow_depth >= 0) flow.print_stats();
+    cout << "Kernel: " << kernel.eliminated() << " nodes eliminated, " << kernel.twins() << " twin nodes ordered"
+            << endl;
     cout << "Recursion: " << n_rec << endl;
 }
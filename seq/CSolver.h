@@ -1,20 +1,92 @@
 #pragma once
 #include <vector>
+#include <chrono>
+#include "CFileReader.h"
+#include "CSpectralBound.h"
+#include "CFlowBound.h"
+#include "CKernel.h"
+#include "CGap.h"
 
 using namespace std;
 
+constexpr double SPARSE_DENSITY = 0.75; // Graphs below this density use the sparse kernels in dfs
+constexpr int TAIL_SIZE = 10; // Subtrees with at most this many unassigned nodes are enumerated by the tail kernel
+constexpr int TAIL_LANES = 16; // Vector width of the tail kernel, at least TAIL_SIZE
+
+constexpr int PROOF_NODES = 1 << 22; // Search tree nodes whose bounds are kept for a warm start
+
+typedef int CTailVector __attribute__((vector_size(4 * TAIL_LANES))); // One lane per unassigned node
+
+struct CProofNode {
+    int bound[2]; // Lower bounds on every cut in the X and Y subtrees
+    int child[2]; // Proof nodes of the X and Y subtrees, -1 if not kept
+};
+
+struct CWarmStart {
+    int min_cut_weight = -1; // Optimum of the previous solve, -1 for none
+    vector<vector<int> > best_partitions; // All its optimal partitions
+    vector<CProofNode> proof; // Bounds of the search tree that proved it, empty after dynamic programming
+    int base_weight = 0; // Optimum when the proof was recorded
+    vector<CWeightChange> changes; // Weight changes since the proof was recorded
+};
+
 class CSolver {
     const int n, a;
-    const vector<vector<int> > graph;
+    const CKernel kernel; // Reductions applied before the search, solutions are lifted back
+    const vector<vector<int> > graph; // Graph in the order of the kernel
+    const CSparseGraph sparse; // Same graph as neighbour lists
+    const int n_search; // Nodes assigned by the search, the isolated nodes after them only fill up X
+    const int x_min; // Fewest nodes in X among the searched nodes
+    const bool use_sparse; // Iterate only over real neighbours in dfs
 
     int min_cut_weight; // Weight of the minimum cut
+    CGap gap; // Allowed distance from the optimum, exact by default
     vector<vector<int> > best_partitions; // Best solutions
     vector<int> partition; // Partition of the nodes
+    int tree_width; // Width of the tree decomposition used instead of the search, or -1
+
+    const int spectral_depth; // Deepest node that adds the spectral bound of the unassigned subgraph
+    const CSpectralBound spectral; // Laplacian eigenvalue bounds
+    int root_bound; // Lower bound on the cut of the whole graph
+    bool proven; // No remaining cut can be within the gap of the best one, so the search can stop
+
+    const int flow_depth; // Deepest node that checks the max-flow bound between assigned X and Y nodes
+    CFlowBound flow; // Max-flow bound with flows reused from parent to child
+
+    CWarmStart warm; // Previous solution and the weight changes since
+    int warm_bound; // Lower bound of the warm start, the search is skipped when the incumbent meets it
+    bool warm_skipped; // The previous optima were proven optimal without searching
+    bool keep_proof; // Record the bounds of this search for the next warm start
+    vector<CProofNode> proof; // Bounds of this search, by dfs path
+
+    double progress_nodes; // Estimated size of the search tree, 0 to hide the progress indicator
+    chrono::time_point<chrono::steady_clock> progress_start, progress_last;
+
+    void report_progress();
+
+    int change_bound(int node) const;
+
+    bool start_warm();
 
 public:
-    CSolver(int n, int a, const vector<vector<int> > &graph);
+    CSolver(int n, int a, const vector<vector<int> > &graph, const CSparseGraph &sparse, int spectral_depth = -1,
+            int flow_depth = -1, bool reduce = true);
+
+    int dfs(int node, int x_count, int cut_weight, int warm_node, int warm_low_bound);
+
+    int tail(int node, int x_count, int cut_weight);
+
+    void record_partition(int cut_weight);
+
+    void record_proof();
+
+    void warm_start(CWarmStart previous, const vector<CWeightChange> &changes);
+
+    CWarmStart get_warm_start();
+
+    void show_progress(double estimated_nodes);
 
-    void dfs(int node, int x_count, int cut_weight);
+    void set_gap(const CGap &gap);
 
     void solve();
 
@@ -0,0 +1,112 @@
+#include "CSpectralBound.h"
+#include <algorithm>
+#include <cmath>
+
+constexpr double EPS = 1e-9; // Relative tolerance of the eigenvalue computation
+
+CSpectralBound::CSpectralBound(const int n, const vector<vector<int> > &graph, const int depth)
+    : n(n), graph(graph), connectivity(n + 1, 0.0) {
+    for (int node = 0; node <= min(depth, n - 2); node++)
+        connectivity[node] = algebraic_connectivity(node);
+}
+
+double CSpectralBound::algebraic_connectivity(const int first) const {
+    const int m = n - first; // Size of the induced subgraph
+
+    // Laplacian of the subgraph induced by nodes first..n-1
+    vector<vector<double> > laplacian(m, vector<double>(m, 0.0));
+    double max_degree = 0;
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < m; j++) {
+            if (i == j) continue;
+            laplacian[i][j] = -graph[first + i][first + j];
+            laplacian[i][i] += graph[first + i][first + j];
+        }
+        max_degree = max(max_degree, laplacian[i][i]);
+    }
+    if (max_degree == 0) return 0.0;
+
+    // Lanczos with full reorthogonalization on the complement of the all-ones vector, run to the full
+    // dimension m - 1 so the tridiagonal matrix has exactly the eigenvalues of the Laplacian there
+    const double ones = 1.0 / sqrt(static_cast<double>(m));
+    vector<vector<double> > basis;
+    vector<double> alpha, beta; // Diagonal and off-diagonal of the tridiagonal matrix
+    vector<double> q(m), w(m);
+    unsigned seed = 12345;
+    bool restart = true;
+    while (static_cast<int>(basis.size()) < m - 1) {
+        if (restart) {
+            for (int i = 0; i < m; i++) {
+                seed = seed * 1103515245u + 12345u;
+                q[i] = static_cast<double>(seed >> 8) / (1u << 24) - 0.5;
+            }
+        } else {
+            q = w;
+        }
+
+        // Project out the all-ones vector and the current basis (twice, for numerical safety)
+        for (int pass = 0; pass < 2; pass++) {
+            double sum = 0;
+            for (int i = 0; i < m; i++) sum += q[i] * ones;
+            for (int i = 0; i < m; i++) q[i] -= sum * ones;
+            for (const auto &b: basis) {
+                double dot = 0;
+                for (int i = 0; i < m; i++) dot += q[i] * b[i];
+                for (int i = 0; i < m; i++) q[i] -= dot * b[i];
+            }
+        }
+        double norm = 0;
+        for (int i = 0; i < m; i++) norm += q[i] * q[i];
+        norm = sqrt(norm);
+
+        if (!restart) {
+            if (norm > EPS * max_degree) {
+                beta.push_back(norm);
+            } else {
+                restart = true; // Invariant subspace found, continue with a fresh vector
+                continue;
+            }
+        } else {
+            if (norm < EPS) continue;
+            if (!basis.empty()) beta.push_back(0.0); // New block of the tridiagonal matrix
+        }
+        for (int i = 0; i < m; i++) q[i] /= norm;
+        basis.push_back(q);
+        restart = false;
+
+        for (int i = 0; i < m; i++) {
+            w[i] = 0;
+            for (int j = 0; j < m; j++) w[i] += laplacian[i][j] * q[j];
+        }
+        double dot = 0;
+        for (int i = 0; i < m; i++) dot += q[i] * w[i];
+        alpha.push_back(dot);
+    }
+
+    // Smallest eigenvalue of the tridiagonal matrix by Sturm sequence bisection
+    const int k = static_cast<int>(alpha.size());
+    if (k == 0) return 0.0;
+    double low = 0.0, high = 2 * max_degree;
+    for (int iteration = 0; iteration < 100 && high - low > EPS * max_degree; iteration++) {
+        const double mid = (low + high) / 2;
+        int below = 0; // Number of eigenvalues smaller than mid
+        double d = 1.0;
+        for (int i = 0; i < k; i++) {
+            const double off = i > 0 ? beta[i - 1] : 0.0;
+            d = alpha[i] - mid - (i > 0 ? off * off / d : 0.0);
+            if (d == 0) d = EPS * max_degree;
+            if (d < 0) below++;
+        }
+        if (below > 0) high = mid;
+        else low = mid;
+    }
+    return max(0.0, low);
+}
+
+int CSpectralBound::bound(const int node, const int x_left) const {
+    // Any split of m nodes into k and m - k cuts at least lambda_2 * k * (m - k) / m inside the subgraph
+    const int m = n - node;
+    if (m < 2 || x_left <= 0 || x_left >= m) return 0;
+    const double value = connectivity[node] * x_left * (m - x_left) / m;
+    return max(0, static_cast<int>(ceil(value - EPS * (1.0 + value) * m)));
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+class CSpectralBound {
+    const int n;
+    const vector<vector<int> > &graph;
+
+    vector<double> connectivity; // Second smallest Laplacian eigenvalue of the subgraph on nodes node..n-1
+
+    double algebraic_connectivity(int first) const;
+
+public:
+    CSpectralBound(int n, const vector<vector<int> > &graph, int depth);
+
+    int bound(int node, int x_left) const;
+};
@@ -0,0 +1,214 @@
+#include "CTreeDecomposition.h"
+#include <algorithm>
+#include <limits>
+
+constexpr int INF = numeric_limits<int>::max() / 2; // Cost of an infeasible table entry
+
+CTreeDecomposition::CTreeDecomposition(const int n, const int a, const vector<vector<int> > &graph)
+    : n(n), a(a), graph(graph), width(0), fixed_node(2 * a == n ? 0 : -1), partition(n, -1) {
+    eliminate();
+}
+
+void CTreeDecomposition::eliminate() {
+    vector<vector<bool> > adjacent(n, vector<bool>(n));
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            adjacent[i][j] = i != j && graph[i][j] != 0;
+
+    vector<bool> eliminated(n, false);
+    vector<int> position(n);
+    scope.assign(n, {});
+    for (int step = 0; step < n; step++) {
+        // Pick the node whose elimination adds the fewest fill edges, then the one with the fewest neighbours
+        int best = -1, best_fill = 0, best_degree = 0;
+        for (int v = 0; v < n; v++) {
+            if (eliminated[v]) continue;
+            vector<int> neighbours;
+            for (int u = 0; u < n; u++) if (!eliminated[u] && adjacent[v][u]) neighbours.push_back(u);
+            int fill = 0;
+            for (size_t i = 0; i < neighbours.size(); i++)
+                for (size_t j = i + 1; j < neighbours.size(); j++)
+                    if (!adjacent[neighbours[i]][neighbours[j]]) fill++;
+            const int degree = static_cast<int>(neighbours.size());
+            if (best == -1 || fill < best_fill || (fill == best_fill && degree < best_degree)) {
+                best = v, best_fill = fill, best_degree = degree;
+            }
+        }
+
+        for (int u = 0; u < n; u++) if (!eliminated[u] && adjacent[best][u]) scope[best].push_back(u);
+        for (const int u: scope[best])
+            for (const int w: scope[best])
+                if (u != w) adjacent[u][w] = true; // Turn the neighbourhood into a clique
+        eliminated[best] = true;
+        position[best] = step;
+        order.push_back(best);
+        width = max(width, best_degree);
+    }
+
+    // The parent of a bag is the bag of its first eliminated neighbour
+    children.assign(n, {});
+    scope_index.assign(n, {});
+    for (const int v: order) {
+        if (scope[v].empty()) {
+            roots.push_back(v);
+            continue;
+        }
+        int parent = scope[v][0];
+        for (const int u: scope[v]) if (position[u] < position[parent]) parent = u;
+        children[parent].push_back(v);
+        for (const int u: scope[v]) {
+            const auto it = find(scope[parent].begin(), scope[parent].end(), u);
+            scope_index[v].push_back(u == parent ? -1 : static_cast<int>(it - scope[parent].begin()));
+        }
+    }
+}
+
+int CTreeDecomposition::get_width() const {
+    return width;
+}
+
+bool CTreeDecomposition::is_narrow() const {
+    // Dense graphs (width close to n) are faster to search than to solve by dynamic programming
+    return width <= TD_MAX_WIDTH && 3 * width <= 2 * n;
+}
+
+int CTreeDecomposition::child_mask(const int child, const int node_value, const int mask) const {
+    int result = 0; // Bit i holds the side (1 = Y) of the i-th scope node of the child
+    for (size_t i = 0; i < scope_index[child].size(); i++) {
+        const int index = scope_index[child][i];
+        const int value = index == -1 ? node_value : (mask >> index) & 1;
+        result |= value << i;
+    }
+    return result;
+}
+
+int CTreeDecomposition::local_cost(const int node, const int node_value, const int mask) const {
+    int cost = 0; // Edges from the node to its scope that end up in the cut
+    for (size_t i = 0; i < scope[node].size(); i++)
+        if (((mask >> i) & 1) != node_value)
+            cost += graph[node][scope[node][i]];
+    return cost;
+}
+
+vector<vector<int> > CTreeDecomposition::suffix_tables(const vector<const int *> &rows, const vector<int> &kids,
+                                                       const int max_count) const {
+    // suffix[i][k] is the cheapest way to place k nodes into X within the subtrees of kids i, i + 1, ...
+    vector<vector<int> > suffix(kids.size() + 1, vector<int>(max_count + 1, INF));
+    suffix[kids.size()][0] = 0;
+    for (int i = static_cast<int>(kids.size()) - 1; i >= 0; i--) {
+        for (int k1 = 0; k1 < counts[kids[i]]; k1++) {
+            if (rows[i][k1] >= INF) continue;
+            for (int k2 = 0; k1 + k2 <= max_count; k2++)
+                if (suffix[i + 1][k2] < INF)
+                    suffix[i][k1 + k2] = min(suffix[i][k1 + k2], rows[i][k1] + suffix[i + 1][k2]);
+        }
+    }
+    return suffix;
+}
+
+int CTreeDecomposition::solve(vector<vector<int> > &best_partitions) {
+    // Bottom-up pass in elimination order, children are always eliminated before their parent
+    tables.assign(n, {});
+    counts.assign(n, 0);
+    vector<int> subtree_size(n, 1);
+    for (const int v: order) {
+        for (const int c: children[v]) subtree_size[v] += subtree_size[c];
+        counts[v] = min(a, subtree_size[v]) + 1;
+
+        const int scope_size = static_cast<int>(scope[v].size());
+        const auto fixed_it = find(scope[v].begin(), scope[v].end(), fixed_node);
+        const int fixed_bit = fixed_it == scope[v].end() ? -1 : static_cast<int>(fixed_it - scope[v].begin());
+        tables[v].assign(static_cast<size_t>(counts[v]) << scope_size, INF);
+
+        vector<int> current(counts[v]), next(counts[v]);
+        for (int mask = 0; mask < 1 << scope_size; mask++) {
+            if (fixed_bit != -1 && ((mask >> fixed_bit) & 1)) continue; // Fixed node must stay in X
+            int *row = &tables[v][static_cast<size_t>(mask) * counts[v]];
+            for (int value = 0; value < 2; value++) {
+                if (v == fixed_node && value == 1) continue;
+
+                // Start with the node itself, then merge the children one by one
+                fill(current.begin(), current.end(), INF);
+                int top = value == 0 ? 1 : 0;
+                if (top >= counts[v]) continue; // No room left in X
+                current[top] = local_cost(v, value, mask);
+                for (const int c: children[v]) {
+                    const int *child_row = &tables[c][static_cast<size_t>(child_mask(c, value, mask)) * counts[c]];
+                    fill(next.begin(), next.end(), INF);
+                    for (int k1 = 0; k1 <= top; k1++) {
+                        if (current[k1] >= INF) continue;
+                        for (int k2 = 0; k2 < counts[c] && k1 + k2 < counts[v]; k2++)
+                            if (child_row[k2] < INF)
+                                next[k1 + k2] = min(next[k1 + k2], current[k1] + child_row[k2]);
+                    }
+                    swap(current, next);
+                    top = min(counts[v] - 1, top + counts[c] - 1);
+                }
+                for (int k = 0; k <= top; k++) row[k] = min(row[k], current[k]);
+            }
+        }
+    }
+
+    // Combine the independent trees of the forest
+    vector<const int *> rows;
+    for (const int r: roots) rows.push_back(tables[r].data());
+    const vector<vector<int> > suffix = suffix_tables(rows, roots, a);
+    const int min_cut_weight = suffix[0][a];
+    if (min_cut_weight >= INF) return numeric_limits<int>::max();
+
+    // Top-down pass enumerating every optimal assignment
+    vector<pair<int, int> > pending;
+    split(rows, roots, suffix, 0, a, min_cut_weight, pending, best_partitions);
+    sort(best_partitions.begin(), best_partitions.end()); // Same order as the depth-first search
+    return min_cut_weight;
+}
+
+void CTreeDecomposition::expand(vector<pair<int, int> > &pending, vector<vector<int> > &best_partitions) {
+    if (pending.empty()) {
+        best_partitions.push_back(partition);
+        return;
+    }
+
+    const auto [v, count] = pending.back();
+    pending.pop_back();
+
+    int mask = 0; // Scope nodes are eliminated later, so they are already assigned
+    for (size_t i = 0; i < scope[v].size(); i++) mask |= partition[scope[v][i]] << i;
+    const int target = tables[v][static_cast<size_t>(mask) * counts[v] + count];
+
+    for (int value = 0; value < 2; value++) {
+        if (v == fixed_node && value == 1) continue;
+        const int rest = count - (value == 0 ? 1 : 0);
+        if (rest < 0) continue;
+
+        vector<const int *> rows;
+        for (const int c: children[v])
+            rows.push_back(&tables[c][static_cast<size_t>(child_mask(c, value, mask)) * counts[c]]);
+        const vector<vector<int> > suffix = suffix_tables(rows, children[v], rest);
+        const int cost = target - local_cost(v, value, mask);
+        if (suffix[0][rest] != cost) continue;
+
+        partition[v] = value;
+        split(rows, children[v], suffix, 0, rest, cost, pending, best_partitions);
+        partition[v] = -1;
+    }
+
+    pending.emplace_back(v, count);
+}
+
+void CTreeDecomposition::split(const vector<const int *> &rows, const vector<int> &kids,
+                               const vector<vector<int> > &suffix, const size_t i, const int count, const int cost,
+                               vector<pair<int, int> > &pending, vector<vector<int> > &best_partitions) {
+    if (i == kids.size()) {
+        expand(pending, best_partitions);
+        return;
+    }
+
+    // Try every |X| share of this child that still leaves an optimal remainder for the others
+    for (int k = 0; k < counts[kids[i]] && k <= count; k++) {
+        if (rows[i][k] >= INF || suffix[i + 1][count - k] != cost - rows[i][k]) continue;
+        pending.emplace_back(kids[i], k);
+        split(rows, kids, suffix, i + 1, count - k, cost - rows[i][k], pending, best_partitions);
+        pending.pop_back();
+    }
+}
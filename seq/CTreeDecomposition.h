@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+constexpr int TD_MAX_WIDTH = 18; // Widest decomposition that is still solved by dynamic programming
+
+class CTreeDecomposition {
+    const int n, a;
+    const vector<vector<int> > &graph;
+
+    int width; // Largest bag size minus one
+    int fixed_node; // Node forced into X to avoid symmetric results, or -1
+    vector<int> order; // Min-fill elimination order
+    vector<vector<int> > scope; // Neighbours of each node when it is eliminated (its bag without the node)
+    vector<vector<int> > scope_index; // Position of each child scope node in the parent bag, -1 for the parent itself
+    vector<vector<int> > children; // Bags whose highest neighbour is eliminated by this node
+    vector<int> roots; // Bags with an empty scope
+    vector<int> counts; // Number of X counts stored per bag assignment (subtree size + 1, at most a + 1)
+    vector<vector<int> > tables; // Minimal cut of each subtree, indexed by bag assignment and |X| in the subtree
+    vector<int> partition; // Partition rebuilt while enumerating optimal solutions
+
+    void eliminate();
+
+    int child_mask(int child, int node_value, int mask) const;
+
+    int local_cost(int node, int node_value, int mask) const;
+
+    vector<vector<int> > suffix_tables(const vector<const int *> &rows, const vector<int> &kids, int max_count) const;
+
+    void expand(vector<pair<int, int> > &pending, vector<vector<int> > &best_partitions);
+
+    void split(const vector<const int *> &rows, const vector<int> &kids, const vector<vector<int> > &suffix, size_t i,
+               int count, int cost, vector<pair<int, int> > &pending, vector<vector<int> > &best_partitions);
+
+public:
+    CTreeDecomposition(int n, int a, const vector<vector<int> > &graph);
+
+    int get_width() const;
+
+    bool is_narrow() const;
+
+    int solve(vector<vector<int> > &best_partitions);
+};
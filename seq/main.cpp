@@ -1,16 +1,20 @@
 #include <iostream>
 #include <vector>
 #include <chrono>
+#include <thread>
 
 #include "CFileReader.h"
 #include "CSolver.h"
+#include "CEstimator.h"
+#include "CTreeDecomposition.h"
 
 using namespace std;
 using namespace chrono;
 
 int main(const int argc, char *argv[]) {
-    if (argc != 3) {
-        cerr << "<Size of set X = 'a'> <input_file>" << endl;
+    if (argc < 3) {
+        cerr << "<Size of set X = 'a'> <input_file> [--spectral <depth>] [--flow <depth>] [--estimate] [--progress]"
+                " [--delta <changes_file>]... [--gap <weight | percent%>]" << endl;
         return 1;
     }
 
@@ -27,17 +31,104 @@ int main(const int argc, char *argv[]) {
     // Read the graph from the input file
     int n;
     vector<vector<int> > graph;
-    if (!file_reader.readFromFile(argv[2], graph, n)) {
+    CSparseGraph sparse;
+    if (!file_reader.readFromFile(argv[2], graph, sparse, n)) {
         return 1;
     }
 
-    // Solve the problem
-    CSolver solver(n, a, graph);
+    // Optional bounds, each applied down to the given depth, and search tree size estimation
+    int spectral_depth = -1, flow_depth = -1;
+    bool estimate = false, progress = false;
+    CGap gap; // Cut weight or percentage the result may be above the optimum
+    vector<string> delta_files; // Weight changes re-solved one after another, each warm-started from the last
+    for (int i = 3; i < argc; i++) {
+        const string option = argv[i];
+        int *depth;
+        if (option == "--delta" && i + 1 < argc) {
+            delta_files.push_back(argv[++i]);
+            continue;
+        } else if (option == "--gap" && i + 1 < argc) {
+            if (!gap.parse(argv[++i])) return 1;
+            continue;
+        } else if (option == "--estimate") {
+            estimate = true;
+            continue;
+        } else if (option == "--progress") {
+            progress = true;
+            continue;
+        } else if (option == "--spectral") {
+            depth = &spectral_depth;
+        } else if (option == "--flow") {
+            depth = &flow_depth;
+        } else {
+            cerr << "Unknown option: " << option << endl;
+            return 1;
+        }
+        if (i + 1 == argc || !file_reader.readInteger(*depth, argv[++i])) {
+            cerr << "Missing depth for " << option << endl;
+            return 1;
+        }
+    }
+
+    // A warm start reuses the bounds of a search that found every optimum
+    if (!gap.is_exact() && !delta_files.empty()) {
+        cerr << "--gap cannot be combined with --delta" << endl;
+        return 1;
+    }
+
+    CEstimator estimator(n, a, graph, TAIL_SIZE);
+    if (estimate || progress) {
+        estimator.run(ESTIMATE_PROBES);
+    }
+
+    if (estimate) {
+        // Recommend an engine and its parameters instead of solving
+        const CTreeDecomposition decomposition(n, a, graph);
+        const string engine = decomposition.is_narrow() ? "seq" : estimator.engine();
+        const int threads = engine == "seq" ? 1 : estimator.threads(static_cast<int>(thread::hardware_concurrency()));
+        cout << "Estimated nodes: " << estimator.get_nodes() << endl;
+        cout << "Engine: " << engine << endl;
+        cout << "Threads: " << threads << endl;
+        cout << "Task depth: " << estimator.task_depth(threads) << endl;
+        cout << "Frontier size: " << estimator.frontier_size(threads) << endl;
+        return 0;
+    }
+
+    // Solve the problem, without reductions if the search is reused after weight changes, which can break twins
+    CSolver solver(n, a, graph, sparse, spectral_depth, flow_depth, delta_files.empty());
+    solver.set_gap(gap);
+    if (progress) {
+        solver.show_progress(estimator.get_nodes());
+    }
+    if (!delta_files.empty()) {
+        solver.record_proof();
+    }
     solver.solve();
 
     // Measure and display execution time
-    const auto end_time = high_resolution_clock::now();
-    const duration<double> elapsed = end_time - start_time;
+    auto end_time = high_resolution_clock::now();
+    duration<double> elapsed = end_time - start_time;
     cout << "Time: " << elapsed.count() << " seconds" << endl;
+
+    // Re-solve after each batch of weight changes, starting from the previous optimum
+    CWarmStart previous = solver.get_warm_start();
+    for (const string &delta_file: delta_files) {
+        const auto delta_start = high_resolution_clock::now();
+        vector<CWeightChange> changes;
+        if (!file_reader.readWeightChanges(delta_file, n, changes)) {
+            return 1;
+        }
+        file_reader.applyWeightChanges(graph, sparse, changes);
+
+        cout << endl << "Delta: " << delta_file << " (" << changes.size() << " changes)" << endl;
+        CSolver warm_solver(n, a, graph, sparse, spectral_depth, flow_depth, false);
+        warm_solver.warm_start(move(previous), changes);
+        warm_solver.solve();
+        previous = warm_solver.get_warm_start();
+
+        end_time = high_resolution_clock::now();
+        elapsed = end_time - delta_start;
+        cout << "Time: " << elapsed.count() << " seconds" << endl;
+    }
     return 0;
 }
@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include <string>
+
+using namespace std;
+
+struct CSparseGraph {
+    vector<int> offsets; // Neighbours of node i are stored at [offsets[i], offsets[i + 1])
+    vector<int> neighbours; // Neighbour indices, sorted in increasing order for each node
+    vector<int> weights; // Edge weights matching the neighbours
+    double density = 0; // Fraction of non-zero entries off the diagonal
+};
+
+struct CBatchEntry {
+    int a; // Size of set X
+    string filename; // Graph of the instance
+};
+
+class CFileReader {
+public:
+    bool readInteger(int &i, const string &argv);
+
+    bool readFromFile(const string &filename, vector<vector<int> > &graph, int &n);
+
+    bool readFromFile(const string &filename, vector<vector<int> > &graph, CSparseGraph &sparse, int &n);
+
+    bool readBatch(const string &filename, vector<CBatchEntry> &entries);
+};
@@ -0,0 +1,168 @@
+#include "CLaneSolver.h"
+#include <algorithm>
+#include <limits>
+
+static bool any_lane(const CLaneVector &mask) {
+    for (int k = 0; k < SIMD_LANES; k++) if (mask[k]) return true;
+    return false;
+}
+
+CLaneSolver::CLaneSolver(const int n, const vector<const vector<vector<int> > *> &graphs, const vector<int> &sizes)
+    : n(n), lanes(static_cast<int>(graphs.size())), weights(static_cast<size_t>(n) * n), a(), fixed_first(),
+      best_partitions(SIMD_LANES), partition(n, -1), n_rec(0) {
+    // Transpose the instances so the weights of one edge in all lanes are loaded by one vector access
+    for (int k = 0; k < lanes; k++) {
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                weights[i * n + j][k] = i == j ? 0 : (*graphs[k])[i][j];
+        a[k] = sizes[k];
+        fixed_first[k] = 2 * sizes[k] == n ? -1 : 0;
+    }
+    for (int k = 0; k < SIMD_LANES; k++) min_cut_weight[k] = numeric_limits<int>::max();
+}
+
+const CLaneVector &CLaneSolver::weight(const int i, const int j) const {
+    return weights[i * n + j];
+}
+
+void CLaneSolver::dfs(const int node, const int x_count, const CLaneVector &cut_weight,
+                      const CLaneVector &parent_active) {
+    n_rec++; // Increment recursion counter
+
+    // Lanes whose cut weight already exceeds their best cut leave the shared path
+    CLaneVector active = parent_active & (cut_weight <= min_cut_weight);
+    if (!any_lane(active))
+        return;
+
+    CLaneVector delta_x = {}, delta_y = {}; // Contribution to cut weight when assigning node to X or Y
+    for (int i = 0; i < node; i++) {
+        if (partition[i] == 0)
+            delta_x += weight(i, node); // Adding edges between node and subset X
+        else
+            delta_y += weight(i, node); // Adding edges between node and subset Y
+    }
+
+    CLaneVector low_bound = {}; // Compute a lower bound for future cut weight, in every lane at once
+    for (int i = node; i < n; i++) {
+        CLaneVector low_bound_x = {}, low_bound_y = {};
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0)
+                low_bound_x += weight(j, i);
+            else
+                low_bound_y += weight(j, i);
+        }
+        low_bound += low_bound_x < low_bound_y ? low_bound_x : low_bound_y; // Minimum possible contribution
+    }
+
+    // Lanes whose minimum possible future cut weight is already worse than their best leave as well
+    active &= low_bound + cut_weight <= min_cut_weight;
+    if (!any_lane(active))
+        return;
+
+    // Small subtrees are enumerated at once instead of recursing node by node
+    if (n - node <= TAIL_SIZE) {
+        tail(node, x_count, cut_weight, active);
+        return;
+    }
+
+    // The node goes to subset X in the lanes where X is not full yet
+    const CLaneVector to_x = active & (x_count < a);
+    if (any_lane(to_x)) {
+        partition[node] = 0;
+        dfs(node + 1, x_count + 1, cut_weight + delta_y, to_x);
+    }
+
+    // And to subset Y where the remaining nodes can still fill X, node 0 stays in X if X and Y are equal in size
+    CLaneVector to_y = active & (a - x_count <= n - node - 1);
+    if (node == 0) to_y &= ~fixed_first;
+    if (any_lane(to_y)) {
+        partition[node] = 1;
+        dfs(node + 1, x_count, cut_weight + delta_x, to_y);
+    }
+}
+
+void CLaneSolver::tail(const int node, const int x_count, const CLaneVector &cut_weight, const CLaneVector &active) {
+    const int remaining = n - node;
+
+    // Cost of each unassigned node towards the assigned ones, and the weights among the unassigned nodes, in
+    // every lane. Moving u to X changes the cut by gain[u] less twice its weight towards the other nodes in X.
+    CLaneVector gain[TAIL_SIZE], in_x[TAIL_SIZE], rows[TAIL_SIZE][TAIL_SIZE];
+    CLaneVector total = cut_weight; // Cut weight of the current mask, which starts with every unassigned node in Y
+    for (int u = 0; u < remaining; u++) {
+        CLaneVector cost_x = {}, cost_y = {}, degree = {};
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0)
+                cost_y += weight(j, node + u); // Cut when u goes to Y
+            else
+                cost_x += weight(j, node + u); // Cut when u goes to X
+        }
+        for (int v = 0; v < remaining; v++) {
+            rows[u][v] = weight(node + u, node + v);
+            degree += rows[u][v];
+        }
+        gain[u] = cost_x - cost_y + degree;
+        in_x[u] = CLaneVector{};
+        total += cost_y;
+    }
+
+    // Lanes that take exactly 'count' more nodes into X, subsets of other sizes need no check
+    CLaneVector size_lanes[TAIL_SIZE + 1];
+    bool size_used[TAIL_SIZE + 1];
+    for (int count = 0; count <= remaining; count++) {
+        size_lanes[count] = active & (a - x_count == count);
+        size_used[count] = any_lane(size_lanes[count]);
+    }
+
+    // Walk all subsets in Gray code order, each step moves one node and updates every lane at once
+    int mask = 0, count = 0;
+    for (int step = 0; step < 1 << remaining; step++) {
+        if (step > 0) {
+            const int u = __builtin_ctz(step);
+            mask ^= 1 << u;
+            if ((mask >> u) & 1) {
+                total += gain[u] - 2 * in_x[u];
+                for (int v = 0; v < remaining; v++) in_x[v] += rows[u][v];
+                count++;
+            } else {
+                for (int v = 0; v < remaining; v++) in_x[v] -= rows[u][v];
+                total -= gain[u] - 2 * in_x[u];
+                count--;
+            }
+        }
+        if (!size_used[count]) continue;
+        CLaneVector found = size_lanes[count] & (total <= min_cut_weight);
+        if (node == 0 && (mask & 1) == 0) found &= ~fixed_first; // Node 0 stays in X if X and Y are equal in size
+        if (any_lane(found)) {
+            for (int u = 0; u < remaining; u++) partition[node + u] = (mask >> u) & 1 ? 0 : 1;
+            for (int k = 0; k < lanes; k++) if (found[k]) record_partition(k, total[k]);
+        }
+    }
+}
+
+void CLaneSolver::record_partition(const int lane, const int cut_weight) {
+    if (cut_weight < min_cut_weight[lane]) {
+        min_cut_weight[lane] = cut_weight; // Update the best cut weight found
+        best_partitions[lane].clear(); // Clear previous partitions
+    }
+    best_partitions[lane].push_back(partition); // Store the new or another optimal partition
+}
+
+void CLaneSolver::solve() {
+    CLaneVector active = {};
+    for (int k = 0; k < lanes; k++) active[k] = -1;
+    dfs(0, 0, CLaneVector{}, active);
+    for (auto &partitions: best_partitions)
+        sort(partitions.begin(), partitions.end()); // The tail kernel finds ties out of order
+}
+
+int CLaneSolver::get_min_cut_weight(const int lane) const {
+    return min_cut_weight[lane];
+}
+
+const vector<vector<int> > &CLaneSolver::get_partitions(const int lane) const {
+    return best_partitions[lane];
+}
+
+long long CLaneSolver::get_recursions() const {
+    return n_rec;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+constexpr int SIMD_LANES = 16; // Instances solved together, one per vector lane
+constexpr int TAIL_SIZE = 10; // Subtrees with at most this many unassigned nodes are enumerated by the tail kernel
+
+typedef int CLaneVector __attribute__((vector_size(4 * SIMD_LANES))); // One lane per instance
+
+// Solves up to SIMD_LANES instances with the same number of nodes in lock-step. All lanes walk one shared search
+// tree, each lane with its own weights, set size and incumbent, and a lane mask tells which lanes are still active
+// in the current subtree.
+class CLaneSolver {
+    const int n;
+    const int lanes; // Instances in this batch, the other lanes stay inactive
+    vector<CLaneVector> weights; // Weight of edge (i, j) of every instance at i * n + j
+    CLaneVector a; // Size of set X of every instance
+    CLaneVector fixed_first; // -1 in lanes where 2a == n, node 0 then stays in X
+
+    CLaneVector min_cut_weight; // Best cut of every instance
+    vector<vector<vector<int> > > best_partitions; // Best solutions of every instance
+    vector<int> partition; // Shared path of the search
+    long long n_rec; // Number of recursions, shared by all lanes
+
+    const CLaneVector &weight(int i, int j) const;
+
+    void dfs(int node, int x_count, const CLaneVector &cut_weight, const CLaneVector &parent_active);
+
+    void tail(int node, int x_count, const CLaneVector &cut_weight, const CLaneVector &active);
+
+    void record_partition(int lane, int cut_weight);
+
+public:
+    CLaneSolver(int n, const vector<const vector<vector<int> > *> &graphs, const vector<int> &sizes);
+
+    void solve();
+
+    int get_min_cut_weight(int lane) const;
+
+    const vector<vector<int> > &get_partitions(int lane) const;
+
+    long long get_recursions() const;
+};
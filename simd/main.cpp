@@ -0,0 +1,101 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <map>
+
+#include "CFileReader.h"
+#include "CLaneSolver.h"
+
+using namespace std;
+using namespace chrono;
+
+struct CInstance {
+    int n;
+    vector<vector<int> > graph;
+    int min_cut_weight;
+    vector<vector<int> > partitions;
+};
+
+int main(const int argc, char *argv[]) {
+    if (argc != 2 && !(argc == 4 && string(argv[2]) == "--lanes")) {
+        cerr << "<batch_file> [--lanes <instances per batch>]" << endl;
+        cerr << "Each line of the batch file holds the size of set X and the input file of one instance" << endl;
+        return 1;
+    }
+
+    // Start measuring execution time
+    const auto start_time = high_resolution_clock::now();
+
+    // Fewer lanes per batch only serve to compare the throughput
+    int lanes = SIMD_LANES;
+    CFileReader file_reader;
+    if (argc == 4 && !file_reader.readInteger(lanes, argv[3])) {
+        return 1;
+    }
+    if (lanes < 1 || lanes > SIMD_LANES) {
+        cerr << "Lanes must be between 1 and " << SIMD_LANES << endl;
+        return 1;
+    }
+
+    // Read every instance, grouped by the number of nodes since a batch shares one search tree
+    vector<CBatchEntry> entries;
+    if (!file_reader.readBatch(argv[1], entries)) {
+        return 1;
+    }
+    vector<CInstance> instances(entries.size());
+    map<int, vector<int> > groups;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (!file_reader.readFromFile(entries[i].filename, instances[i].graph, instances[i].n)) {
+            return 1;
+        }
+        if (entries[i].a < 0 || entries[i].a > instances[i].n) {
+            cerr << "Invalid size of set X for " << entries[i].filename << endl;
+            return 1;
+        }
+        groups[instances[i].n].push_back(static_cast<int>(i));
+    }
+
+    // Solve the instances of each group in batches of lanes
+    long long n_rec = 0, batches = 0;
+    for (const auto &[n, members]: groups) {
+        for (size_t first = 0; first < members.size(); first += lanes) {
+            vector<const vector<vector<int> > *> graphs;
+            vector<int> sizes;
+            for (size_t k = first; k < members.size() && k < first + lanes; k++) {
+                graphs.push_back(&instances[members[k]].graph);
+                sizes.push_back(entries[members[k]].a);
+            }
+            CLaneSolver solver(n, graphs, sizes);
+            solver.solve();
+            for (size_t k = 0; k < graphs.size(); k++) {
+                CInstance &instance = instances[members[first + k]];
+                instance.min_cut_weight = solver.get_min_cut_weight(static_cast<int>(k));
+                instance.partitions = solver.get_partitions(static_cast<int>(k));
+            }
+            n_rec += solver.get_recursions();
+            batches++;
+        }
+    }
+
+    // Print the results in the order of the batch file
+    for (size_t i = 0; i < instances.size(); i++) {
+        const CInstance &instance = instances[i];
+        cout << "Instance: " << entries[i].a << " " << entries[i].filename << endl;
+        cout << "Min Cut weight: " << instance.min_cut_weight << endl;
+        for (const auto &it: instance.partitions) {
+            cout << "X: ";
+            for (int j = 0; j < instance.n; j++) if (it[j] == 0) cout << j << " ";
+            cout << endl << "Y: ";
+            for (int j = 0; j < instance.n; j++) if (it[j] == 1) cout << j << " ";
+            cout << endl;
+        }
+    }
+    cout << "Instances: " << instances.size() << " in " << batches << " batches" << endl;
+    cout << "Recursion: " << n_rec << endl;
+
+    // Measure and display execution time
+    const auto end_time = high_resolution_clock::now();
+    const duration<double> elapsed = end_time - start_time;
+    cout << "Time: " << elapsed.count() << " seconds" << endl;
+    return 0;
+}
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Picks the engine and thread count from the search tree size estimated by seq, then runs it.
+# Usage: ./solve.sh <Size of set X = 'a'> <input_file>
+# MPI_PROCESSES sets the number of processes when the mpi engine is chosen (default 4).
+
+if [ $# -ne 2 ]; then
+    echo "<Size of set X = 'a'> <input_file>" >&2
+    exit 1
+fi
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+ESTIMATE=$("$DIR/seq/seq" "$1" "$2" --estimate) || exit 1
+ENGINE=$(echo "$ESTIMATE" | sed -n 's/^Engine: //p')
+THREADS=$(echo "$ESTIMATE" | sed -n 's/^Threads: //p')
+echo "$ESTIMATE" >&2
+
+case $ENGINE in
+    seq) exec "$DIR/seq/seq" "$1" "$2" ;;
+    mpi) OMP_NUM_THREADS=$THREADS exec mpirun -np "${MPI_PROCESSES:-4}" "$DIR/mpi/mpi" "$1" "$2" ;;
+    *) OMP_NUM_THREADS=$THREADS exec "$DIR/$ENGINE/$ENGINE" "$1" "$2" ;;
+esac
@@ -40,3 +40,45 @@ bool CFileReader::readFromFile(const string &filename, vector<vector<int> > &gra
     file.close();
     return true;
 }
+
+bool CFileReader::readFromFile(const string &filename, vector<vector<int> > &graph, CSparseGraph &sparse, int &n) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Could not open file: " << filename << endl;
+        return false;
+    }
+    return readFromStream(file, graph, sparse, n);
+}
+
+bool CFileReader::readFromStream(istream &input, vector<vector<int> > &graph, CSparseGraph &sparse, int &n) {
+    // Read the number of nodes and the graph, rejecting truncated or malformed input
+    if (!(input >> n) || n <= 0 || n >= MAX_NODES) {
+        cerr << "Invalid number of nodes" << endl;
+        return false;
+    }
+    graph.assign(n, vector<int>(n));
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (!(input >> graph[i][j])) {
+                cerr << "Invalid graph" << endl;
+                return false;
+            }
+        }
+    }
+
+    // Build the compressed sparse row (CSR) adjacency from the dense matrix
+    sparse.offsets.assign(1, 0);
+    sparse.neighbours.clear();
+    sparse.weights.clear();
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j && graph[i][j] != 0) {
+                sparse.neighbours.push_back(j);
+                sparse.weights.push_back(graph[i][j]);
+            }
+        }
+        sparse.offsets.push_back(static_cast<int>(sparse.neighbours.size()));
+    }
+    sparse.density = n > 1 ? static_cast<double>(sparse.neighbours.size()) / (n * (n - 1.0)) : 1.0;
+    return true;
+}
@@ -1,12 +1,26 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <istream>
 
 using namespace std;
 
+constexpr int MAX_NODES = 100; // Graphs have fewer nodes than this, larger ones are rejected before allocating
+
+struct CSparseGraph {
+    vector<int> offsets; // Neighbours of node i are stored at [offsets[i], offsets[i + 1])
+    vector<int> neighbours; // Neighbour indices, sorted in increasing order for each node
+    vector<int> weights; // Edge weights matching the neighbours
+    double density = 0; // Fraction of non-zero entries off the diagonal
+};
+
 class CFileReader {
 public:
     bool readInteger(int &i, const string &argv);
 
     bool readFromFile(const string &filename, vector<vector<int> > &graph, int &n);
+
+    bool readFromFile(const string &filename, vector<vector<int> > &graph, CSparseGraph &sparse, int &n);
+
+    bool readFromStream(istream &input, vector<vector<int> > &graph, CSparseGraph &sparse, int &n);
 };
@@ -0,0 +1,257 @@
+#include "CPortfolio.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <omp.h>
+#include "CSolver.h"
+
+CPortfolio::CPortfolio(const int n, const int a, const vector<vector<int> > &graph, const int size)
+    : n(n), a(a), graph(graph), min_cut_weight(numeric_limits<int>::max()), winner(-1) {
+    // The input order first, then orders that assign heavily connected nodes early so the bounds bite sooner
+    vector<int> identity(n);
+    iota(identity.begin(), identity.end(), 0);
+    add_strategy("input order, X first", identity, EValueOrder::X_FIRST);
+    add_strategy("max adjacency order, cheaper first", adjacency_order(-1, 0), EValueOrder::CHEAPER_FIRST);
+    add_strategy("degree order, cheaper first", degree_order(), EValueOrder::CHEAPER_FIRST);
+    add_strategy("input order, Y first", identity, EValueOrder::Y_FIRST);
+
+    // Randomized max adjacency orders for the remaining threads
+    mt19937 random(1);
+    for (unsigned seed = 1; static_cast<int>(strategies.size()) < size; seed++) {
+        const int start = static_cast<int>(random() % n);
+        const EValueOrder value_order = random() % 2 == 0 ? EValueOrder::CHEAPER_FIRST : EValueOrder::X_FIRST;
+        add_strategy("random adjacency order, seed " + to_string(seed), adjacency_order(start, seed), value_order);
+    }
+    strategies.resize(max(1, size));
+}
+
+vector<int> CPortfolio::degree_order() const {
+    vector<int> order(n), weight(n, 0);
+    iota(order.begin(), order.end(), 0);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            weight[i] += graph[i][j];
+    stable_sort(order.begin(), order.end(), [&weight](const int u, const int v) { return weight[u] > weight[v]; });
+    return order;
+}
+
+vector<int> CPortfolio::adjacency_order(const int start, const unsigned seed) const {
+    // Next is the node with the most weight towards the nodes already ordered, ties broken at random
+    mt19937 random(seed);
+    vector<int> order, connection(n, 0), noise(n, 0);
+    if (seed != 0)
+        for (auto &value: noise) value = static_cast<int>(random() % 16);
+    vector<bool> ordered(n, false);
+    for (int step = 0; step < n; step++) {
+        int next = -1;
+        for (int v = 0; v < n; v++) {
+            if (ordered[v]) continue;
+            if (next == -1 || connection[v] + noise[v] > connection[next] + noise[next]) next = v;
+        }
+        if (step == 0 && start >= 0) next = start;
+        ordered[next] = true;
+        order.push_back(next);
+        for (int v = 0; v < n; v++) connection[v] += graph[next][v];
+    }
+    return order;
+}
+
+void CPortfolio::add_strategy(const string &name, const vector<int> &order, const EValueOrder value_order) {
+    CStrategy strategy;
+    strategy.name = name;
+    strategy.order = order;
+    strategy.value_order = value_order;
+    strategy.found = CPartitionArena(n);
+    strategy.found_weight = numeric_limits<int>::max();
+    strategy.n_rec = 0;
+    strategies.push_back(move(strategy));
+}
+
+void CPortfolio::dfs(CStrategy &strategy, const int node, const int x_count, const int cut_weight) {
+    strategy.n_rec++;
+
+    // Another strategy has proven the optimum, and cuts above the shared best (less the gap) cannot win
+    const int limit = gap.limit(min_cut_weight.load(memory_order_relaxed));
+    if (winner.load(memory_order_relaxed) != -1 || cut_weight > limit)
+        return;
+
+    if (node == n) {
+        if (x_count == a)
+            record_partition(strategy, cut_weight);
+        return;
+    }
+
+    const vector<vector<int> > &g = strategy.graph;
+    vector<int> &partition = strategy.partition;
+    int delta_x = 0, delta_y = 0; // Contribution to cut weight when assigning node to X or Y
+    for (int i = 0; i < node; i++) {
+        if (partition[i] == 0)
+            delta_x += g[i][node];
+        else
+            delta_y += g[i][node];
+    }
+
+    int low_bound = 0; // Same bound as the task engine's dfs
+    for (int i = node; i < n; i++) {
+        int low_bound_x = 0, low_bound_y = 0;
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0)
+                low_bound_x += g[j][i];
+            else
+                low_bound_y += g[j][i];
+        }
+        low_bound += min(low_bound_x, low_bound_y);
+    }
+    if (low_bound + cut_weight > limit)
+        return;
+
+    if (n - node <= TAIL_SIZE) {
+        tail(strategy, node, x_count, cut_weight);
+        return;
+    }
+
+    int first = 0; // Side searched first
+    if (strategy.value_order == EValueOrder::Y_FIRST ||
+        (strategy.value_order == EValueOrder::CHEAPER_FIRST && delta_x < delta_y))
+        first = 1;
+    for (int k = 0; k < 2; k++) {
+        const int value = first ^ k;
+        if (value == 0 && x_count == a) continue;
+        partition[node] = value;
+        dfs(strategy, node + 1, x_count + 1 - value, cut_weight + (value == 0 ? delta_y : delta_x));
+    }
+}
+
+void CPortfolio::tail(CStrategy &strategy, const int node, const int x_count, const int cut_weight) {
+    const int remaining = n - node, x_left = a - x_count;
+    if (x_left < 0 || x_left > remaining)
+        return;
+    const vector<vector<int> > &g = strategy.graph;
+    vector<int> &partition = strategy.partition;
+
+    // Same Gray code enumeration as CSolver::tail
+    int cost_x[TAIL_LANES], cost_y[TAIL_LANES], degree[TAIL_LANES];
+    CTailVector rows[TAIL_LANES] = {};
+    int total = cut_weight;
+    for (int u = 0; u < remaining; u++) {
+        cost_x[u] = cost_y[u] = degree[u] = 0;
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0)
+                cost_y[u] += g[j][node + u];
+            else
+                cost_x[u] += g[j][node + u];
+        }
+        for (int v = 0; v < remaining; v++) {
+            if (v == u) continue;
+            rows[u][v] = g[node + u][node + v];
+            degree[u] += rows[u][v];
+        }
+        total += cost_y[u];
+    }
+
+    CTailVector in_x = {};
+    int mask = 0, count = 0;
+    for (int step = 0; step < 1 << remaining; step++) {
+        if (step > 0) {
+            const int u = __builtin_ctz(step);
+            mask ^= 1 << u;
+            if ((mask >> u) & 1) {
+                total += cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                in_x += rows[u];
+                count++;
+            } else {
+                in_x -= rows[u];
+                total -= cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                count--;
+            }
+        }
+        if (count == x_left && total <= min_cut_weight.load(memory_order_relaxed)) {
+            for (int u = 0; u < remaining; u++) partition[node + u] = (mask >> u) & 1 ? 0 : 1;
+            record_partition(strategy, total);
+        }
+    }
+}
+
+void CPortfolio::record_partition(CStrategy &strategy, const int cut_weight) {
+    // Every strategy keeps its own optima, the one that finishes has seen all cuts of the final weight
+    if (cut_weight < strategy.found_weight) {
+        strategy.found_weight = cut_weight;
+        strategy.found.clear();
+    }
+    strategy.found.push_back(strategy.partition);
+
+    int best = min_cut_weight.load(memory_order_relaxed);
+    while (cut_weight < best && !min_cut_weight.compare_exchange_weak(best, cut_weight)) {
+    }
+}
+
+void CPortfolio::set_gap(const CGap &gap) {
+    this->gap = gap;
+}
+
+void CPortfolio::solve(ostream &out) {
+    const int size = static_cast<int>(strategies.size());
+    const cpu_set_t affinity = CTopology::get_affinity(); // The calling thread is pinned as thread 0
+    #pragma omp parallel num_threads(size)
+    {
+        const int thread = omp_get_thread_num();
+        topology.pin_thread(thread);
+        CStrategy &strategy = strategies[thread];
+
+        // Relabel the graph on the searching thread, so its pages stay on the thread's NUMA node
+        strategy.graph.assign(n, vector<int>(n));
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                strategy.graph[i][j] = graph[strategy.order[i]][strategy.order[j]];
+        strategy.partition.assign(n, -1);
+
+        if (2 * a == n) {
+            strategy.partition[0] = 0; // Fixing the first node in X avoids finding every partition twice
+            dfs(strategy, 1, 1, 0);
+        } else {
+            dfs(strategy, 0, 0, 0);
+        }
+
+        int none = -1;
+        if (winner.load() == -1) winner.compare_exchange_strong(none, thread);
+    }
+
+    CTopology::set_affinity(affinity);
+
+    // Translate the partitions back, with node 0 in X when both sides have the same size. The winner found
+    // every optimum of an exact search, with a gap the best cut may come from a strategy that was stopped.
+    for (const CStrategy &strategy: strategies) {
+        if (strategy.found_weight != min_cut_weight) continue;
+        for (size_t k = 0; k < strategy.found.get_count(); k++) {
+            const int *found = strategy.found[k];
+            vector<int> partition(n);
+            for (int i = 0; i < n; i++) partition[strategy.order[i]] = found[i];
+            if (2 * a == n && partition[0] == 1)
+                for (auto &value: partition) value ^= 1;
+            best_partitions.push_back(partition);
+        }
+    }
+    sort(best_partitions.begin(), best_partitions.end());
+    best_partitions.erase(unique(best_partitions.begin(), best_partitions.end()), best_partitions.end());
+    print_solution(out);
+}
+
+void CPortfolio::print_solution(ostream &out) const {
+    out << "Min Cut weight: " << min_cut_weight << endl;
+    if (!gap.is_exact()) out << "Guaranteed ratio: " << gap.ratio(min_cut_weight) << endl;
+    for (const auto &it: best_partitions) {
+        out << "X: ";
+        for (int j = 0; j < n; j++) if (it[j] == 0) out << j << " ";
+        out << endl << "Y: ";
+        for (int j = 0; j < n; j++) if (it[j] == 1) out << j << " ";
+        out << endl;
+    }
+    long long n_rec = 0;
+    for (const auto &strategy: strategies) n_rec += strategy.n_rec;
+    out << "Strategy: " << strategies[winner].name << " (first of " << strategies.size() << ")" << endl;
+    out << "Recursion: " << n_rec << endl;
+    long long allocations = 0;
+    for (const auto &strategy: strategies) allocations += strategy.found.get_allocations();
+    out << "Allocations: " << allocations << endl;
+}
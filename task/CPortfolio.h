@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "CTopology.h"
+#include "CGap.h"
+#include "CArena.h"
+
+using namespace std;
+
+enum class EValueOrder { X_FIRST, Y_FIRST, CHEAPER_FIRST };
+
+struct CStrategy {
+    string name; // Shown for the strategy that finishes first
+    vector<int> order; // Original node searched at each depth
+    EValueOrder value_order; // Which child is searched first
+    vector<vector<int> > graph; // Graph relabelled by the order, owned by the searching thread
+    vector<int> partition; // Partition by depth
+    int found_weight; // Best cut found by this strategy
+    CPartitionArena found; // Partitions of that weight found by this strategy, by depth
+    long long n_rec; // Number of recursions of this strategy
+};
+
+class CPortfolio {
+    const int n, a;
+    const vector<vector<int> > &graph;
+
+    vector<CStrategy> strategies;
+    atomic<int> min_cut_weight; // Best cut of all strategies, shared for pruning
+    atomic<int> winner; // First strategy to finish its search, -1 while all are running
+    vector<vector<int> > best_partitions; // Optimal partitions of the winner in original node labels
+    CGap gap; // Allowed distance from the optimum, exact by default
+
+    const CTopology topology; // CPUs the strategies are pinned to, like the task engine's threads
+
+    vector<int> degree_order() const;
+
+    vector<int> adjacency_order(int start, unsigned seed) const;
+
+    void add_strategy(const string &name, const vector<int> &order, EValueOrder value_order);
+
+    void dfs(CStrategy &strategy, int node, int x_count, int cut_weight);
+
+    void tail(CStrategy &strategy, int node, int x_count, int cut_weight);
+
+    void record_partition(CStrategy &strategy, int cut_weight);
+
+public:
+    CPortfolio(int n, int a, const vector<vector<int> > &graph, int size);
+
+    void set_gap(const CGap &gap);
+
+    void solve(ostream &out);
+
+    void print_solution(ostream &out) const;
+};
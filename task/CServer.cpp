@@ -0,0 +1,300 @@
+#include "CServer.h"
+#include "CSolver.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace chrono;
+
+CServer::CServer(const string &socket_path, const string &cache_dir)
+    : socket_path(socket_path), cache_dir(cache_dir) {
+}
+
+string CServer::hash_key(const string &key) {
+    unsigned long long hash = 14695981039346656037ull; // 64-bit FNV-1a
+    for (const unsigned char c: key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    ostringstream out;
+    out << hex << setw(16) << setfill('0') << hash;
+    return out.str();
+}
+
+bool CServer::load(const string &key, string &result) const {
+    if (cache_dir.empty()) return false;
+    ifstream file(cache_dir + "/" + hash_key(key) + ".txt");
+    if (!file.is_open()) return false;
+
+    // The first line holds the full request, so a hash collision is never served
+    string stored_key;
+    if (!getline(file, stored_key) || stored_key != key) return false;
+    ostringstream content;
+    content << file.rdbuf();
+    result = content.str();
+    return true;
+}
+
+void CServer::store(const string &key, const string &result) const {
+    if (cache_dir.empty()) return;
+    const string path = cache_dir + "/" + hash_key(key) + ".txt";
+    const string temporary = path + ".tmp" + to_string(hash<thread::id>()(this_thread::get_id()));
+    {
+        ofstream file(temporary);
+        if (!file.is_open()) {
+            cerr << "Could not write cache file: " << temporary << endl;
+            return;
+        }
+        file << key << '\n' << result;
+    }
+    rename(temporary.c_str(), path.c_str()); // Readers never see a partial file
+}
+
+string CServer::compute(const int n, const int a, const vector<vector<int> > &graph, const CSparseGraph &sparse) {
+    packaged_task<string()> job([n, a, &graph, &sparse] {
+        CSolver solver(n, a, graph, sparse);
+        ostringstream out;
+        solver.solve(out);
+        return out.str();
+    });
+    future<string> result = job.get_future();
+    {
+        lock_guard<mutex> lock(jobs_mutex);
+        jobs.push_back(move(job));
+    }
+    jobs_ready.notify_one();
+    return result.get();
+}
+
+void CServer::solver_loop() {
+    // Every search starts from this thread, so OpenMP keeps reusing the same pinned thread pool
+    while (true) {
+        packaged_task<string()> job;
+        {
+            unique_lock<mutex> lock(jobs_mutex);
+            jobs_ready.wait(lock, [this] { return !jobs.empty(); });
+            job = move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+
+string CServer::stats() const {
+    const long long total = requests, hits = memory_hits + disk_hits + coalesced, answered = total - errors;
+    ostringstream out;
+    out << "Requests: " << total << endl;
+    out << "Memory hits: " << memory_hits << endl;
+    out << "Disk hits: " << disk_hits << endl;
+    out << "Coalesced: " << coalesced << endl;
+    out << "Solved: " << solved << endl;
+    out << "Errors: " << errors << endl;
+    out << "Hit rate: " << (total > 0 ? 100.0 * hits / total : 0.0) << " %" << endl;
+    out << "Average latency: " << (answered > 0 ? total_micros / 1000.0 / answered : 0.0) << " ms" << endl;
+    out << "Max latency: " << max_micros / 1000.0 << " ms" << endl;
+    return out.str();
+}
+
+bool CServer::lookup(const string &key, string &result) {
+    const auto cached = cache.find(key);
+    if (cached == cache.end()) return false;
+    cache_order.splice(cache_order.begin(), cache_order, cached->second.second); // Now the most recently used
+    result = cached->second.first;
+    return true;
+}
+
+void CServer::remember(const string &key, const string &result) {
+    if (cache.count(key) != 0) return;
+    cache_order.push_front(key);
+    cache[key] = {result, cache_order.begin()};
+    if (cache.size() > CACHE_ENTRIES) {
+        cache.erase(cache_order.back()); // Evict the least recently used result
+        cache_order.pop_back();
+    }
+}
+
+string CServer::answer(const string &request) {
+    const auto start_time = high_resolution_clock::now();
+    istringstream input(request);
+    string first;
+    input >> first;
+    if (first == "STATS") return stats();
+
+    requests++;
+    int a, n;
+    vector<vector<int> > graph;
+    CSparseGraph sparse;
+    CFileReader reader;
+    if (!reader.readInteger(a, first) || !reader.readFromStream(input, graph, sparse, n) || a < 1 || a > n) {
+        errors++;
+        return "Error: expected <Size of set X = 'a'> followed by a graph\n";
+    }
+
+    // Canonical form of the request, used as the cache key
+    ostringstream key_stream;
+    key_stream << a << ' ' << n;
+    for (const auto &row: graph) for (const int w: row) key_stream << ' ' << w;
+    const string key = key_stream.str();
+
+    string result, source;
+    bool leader = false;
+    promise<string> done;
+    shared_future<string> pending;
+    {
+        lock_guard<mutex> lock(cache_mutex);
+        if (lookup(key, result)) {
+            source = "memory";
+            memory_hits++;
+        } else {
+            const auto running = in_flight.find(key);
+            if (running != in_flight.end()) {
+                pending = running->second; // Same request already being solved, wait for it
+                source = "coalesced";
+                coalesced++;
+            } else {
+                leader = true;
+                in_flight[key] = done.get_future().share();
+            }
+        }
+    }
+
+    if (leader) {
+        try {
+            if (load(key, result)) {
+                source = "disk";
+                disk_hits++;
+            } else {
+                result = compute(n, a, graph, sparse);
+                source = "solved";
+                solved++;
+                store(key, result);
+            }
+        } catch (...) {
+            // Waiting requests get the same error, later ones try again
+            {
+                lock_guard<mutex> lock(cache_mutex);
+                in_flight.erase(key);
+            }
+            done.set_exception(current_exception());
+            throw;
+        }
+        {
+            lock_guard<mutex> lock(cache_mutex);
+            remember(key, result);
+            in_flight.erase(key);
+        }
+        done.set_value(result);
+    } else if (pending.valid()) {
+        result = pending.get();
+    }
+
+    const duration<double> elapsed = high_resolution_clock::now() - start_time;
+    const long long micros = duration_cast<microseconds>(elapsed).count();
+    total_micros += micros;
+    long long previous = max_micros;
+    while (micros > previous && !max_micros.compare_exchange_weak(previous, micros)) {
+    }
+
+    ostringstream out;
+    out << result << "Cache: " << source << endl << "Time: " << elapsed.count() << " seconds" << endl;
+    return out.str();
+}
+
+void CServer::handle(const int client) {
+    // A request is the size of set X followed by a graph in the input file format, ended by closing the write side
+    string request;
+    char buffer[4096];
+    ssize_t received;
+    while ((received = read(client, buffer, sizeof(buffer))) > 0) request.append(buffer, received);
+
+    string response;
+    if (received < 0) {
+        requests++;
+        errors++;
+        response = "Error: request not completed within " + to_string(READ_TIMEOUT) + " seconds\n";
+    } else {
+        // A bad request must not end the server, which runs every request on a detached thread
+        try {
+            response = answer(request);
+        } catch (const exception &e) {
+            errors++;
+            response = string("Error: ") + e.what() + "\n";
+        }
+    }
+
+    for (size_t sent = 0; sent < response.size();) {
+        const ssize_t written = write(client, response.data() + sent, response.size() - sent);
+        if (written <= 0) break;
+        sent += written;
+    }
+    close(client);
+
+    lock_guard<mutex> lock(handlers_mutex);
+    handlers--;
+    handler_done.notify_one();
+}
+
+bool CServer::run() {
+    signal(SIGPIPE, SIG_IGN); // Clients that disconnect early must not kill the server
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        cerr << "Socket path too long: " << socket_path << endl;
+        return false;
+    }
+    strcpy(address.sun_path, socket_path.c_str());
+
+    const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        perror("socket");
+        return false;
+    }
+    unlink(socket_path.c_str());
+    if (bind(server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(server, 64) < 0) {
+        perror("bind");
+        close(server);
+        return false;
+    }
+
+    thread(&CServer::solver_loop, this).detach();
+    cout << "Listening on " << socket_path << endl;
+
+    while (true) {
+        // Above the handler limit new connections wait in the listen backlog
+        {
+            unique_lock<mutex> lock(handlers_mutex);
+            handler_done.wait(lock, [this] { return handlers < MAX_HANDLERS; });
+        }
+        const int client = accept(server, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+
+        // Clients that stop sending are dropped instead of holding a handler forever
+        timeval timeout{};
+        timeout.tv_sec = READ_TIMEOUT;
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        {
+            lock_guard<mutex> lock(handlers_mutex);
+            handlers++;
+        }
+        thread(&CServer::handle, this, client).detach();
+    }
+    close(server);
+    return false;
+}
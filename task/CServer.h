@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CFileReader.h"
+
+using namespace std;
+
+constexpr size_t CACHE_ENTRIES = 1024; // Results kept in memory, the least recently used one is dropped first
+constexpr int READ_TIMEOUT = 10; // Seconds a client may take to send its request
+constexpr int MAX_HANDLERS = 64; // Requests handled at the same time, further connections wait to be accepted
+
+class CServer {
+    const string socket_path; // Unix domain socket the server listens on
+    const string cache_dir; // Directory of the on-disk cache, empty to keep results in memory only
+
+    mutex cache_mutex; // Guards the memory cache and the in-flight requests
+    unordered_map<string, pair<string, list<string>::iterator> > cache; // Solution text by canonical request
+    list<string> cache_order; // Cached requests from the most to the least recently used
+    unordered_map<string, shared_future<string> > in_flight; // Requests being solved right now
+
+    mutex jobs_mutex; // Guards the job queue
+    condition_variable jobs_ready;
+    deque<packaged_task<string()> > jobs; // Searches run one at a time by the solver thread and its OpenMP pool
+
+    mutex handlers_mutex; // Guards the number of running handlers
+    condition_variable handler_done;
+    int handlers = 0; // Connections being handled right now
+
+    atomic<long long> requests{0}, memory_hits{0}, disk_hits{0}, coalesced{0}, solved{0}, errors{0};
+    atomic<long long> total_micros{0}, max_micros{0}; // Request latency
+
+    static string hash_key(const string &key);
+
+    bool load(const string &key, string &result) const;
+
+    void store(const string &key, const string &result) const;
+
+    string compute(int n, int a, const vector<vector<int> > &graph, const CSparseGraph &sparse);
+
+    void solver_loop();
+
+    string stats() const;
+
+    bool lookup(const string &key, string &result);
+
+    void remember(const string &key, const string &result);
+
+    string answer(const string &request);
+
+    void handle(int client);
+
+public:
+    CServer(const string &socket_path, const string &cache_dir);
+
+    bool run();
+};
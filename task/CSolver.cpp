@@ -3,80 +3,254 @@
 #include <iostream>
 #include <limits>
 #include <omp.h>
+#include "CEstimator.h"
 
-long long n_rec = 0; // Number of recursions
-
-CSolver::CSolver(const int n, const int a, const vector<vector<int> > &graph)
-    : n(n), a(a), graph(graph), min_cut_weight(numeric_limits<int>::max()) {
+CSolver::CSolver(const int n, const int a, const vector<vector<int> > &graph, const CSparseGraph &sparse)
+    : n(n), a(a), graph(graph), sparse(sparse), use_sparse(sparse.density < SPARSE_DENSITY),
+      min_cut_weight(numeric_limits<int>::max()), best_partitions(n), n_rec(0), threads(1), task_depth(0),
+      progress_nodes(0) {
 }
 
 void CSolver::dfs(const int node, const int x_count, const int cut_weight, vector<int> &partition) {
-    #pragma omp atomic update
-    n_rec++; // Atomically increment the recursion counter
+    long long calls;
+    #pragma omp atomic capture
+    calls = ++n_rec; // Atomically increment the recursion counter
+    if (progress_nodes > 0 && (calls & 0xFFFF) == 0)
+        report_progress(calls);
+
+    // Work on the graph and best cut weight of this thread's NUMA node
+    const int numa_node = thread_node[omp_get_thread_num()];
+    const CReplica &replica = replicas[numa_node];
+    const CNodeBound &bound = node_bounds[numa_node];
 
-    // Prune the search if the current cut weight exceeds the best found so far
-    if (cut_weight > min_cut_weight)
+    // Prune the search if the current cut weight exceeds the best found so far, less the allowed gap
+    const int limit = gap.limit(bound.min_cut_weight);
+    if (cut_weight > limit)
         return;
 
     // If all nodes are processed, check if a valid partition is found
     if (node == n) {
-        // Ensure the subset X has exactly 'a' elements
-        if (x_count == a) {
-            #pragma omp critical
-            {
-                if (cut_weight == min_cut_weight) {
-                    best_partitions.push_back(partition); // Store another optimal partition
-                } else if (cut_weight < min_cut_weight) {
-                    min_cut_weight = cut_weight; // Update the best cut weight found
-                    best_partitions.clear(); // Clear previous partitions
-                    best_partitions.push_back(partition); // Store the new best partition
-                }
-            }
-        }
+        if (x_count == a) // Ensure the subset X has exactly 'a' elements
+            record_partition(cut_weight, partition);
         return;
     }
 
     int delta_x = 0, delta_y = 0; // Contribution to cut weight when assigning node to X or Y
-    for (int i = 0; i < node; i++) {
-        if (partition[i] == 0)
-            delta_x += graph[i][node]; // Adding edges between node and subset X
-        else
-            delta_y += graph[i][node]; // Adding edges between node and subset Y
-    }
-
     int low_bound_x = 0, low_bound_y = 0, low_bound = 0; // Compute a lower bound for future cut weight
-    for (int i = node; i < n; i++) {
-        for (int j = 0; j < node; j++) {
-            if (partition[j] == 0)
-                low_bound_x += graph[j][i];
+    if (use_sparse) {
+        // Neighbour lists are sorted, so only the neighbours already assigned are visited
+        const int *neighbours = replica.sparse.neighbours.data(), *weights = replica.sparse.weights.data();
+        const int *offsets = replica.sparse.offsets.data();
+        for (int e = offsets[node]; e < offsets[node + 1] && neighbours[e] < node; e++) {
+            if (partition[neighbours[e]] == 0)
+                delta_x += weights[e]; // Adding edges between node and subset X
             else
-                low_bound_y += graph[j][i];
+                delta_y += weights[e]; // Adding edges between node and subset Y
+        }
+
+        for (int i = node; i < n; i++) {
+            for (int e = offsets[i]; e < offsets[i + 1] && neighbours[e] < node; e++) {
+                if (partition[neighbours[e]] == 0)
+                    low_bound_x += weights[e];
+                else
+                    low_bound_y += weights[e];
+            }
+            low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+            low_bound_x = 0, low_bound_y = 0;
+        }
+    } else {
+        for (int i = 0; i < node; i++) {
+            if (partition[i] == 0)
+                delta_x += replica.graph[i][node]; // Adding edges between node and subset X
+            else
+                delta_y += replica.graph[i][node]; // Adding edges between node and subset Y
+        }
+
+        for (int i = node; i < n; i++) {
+            for (int j = 0; j < node; j++) {
+                if (partition[j] == 0)
+                    low_bound_x += replica.graph[j][i];
+                else
+                    low_bound_y += replica.graph[j][i];
+            }
+            low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
+            low_bound_x = 0, low_bound_y = 0;
         }
-        low_bound += min(low_bound_x, low_bound_y); // Minimum possible contribution to the cut
-        low_bound_x = 0, low_bound_y = 0;
     }
 
     // Stop if the minimum possible future cut weight is already worse than the best found
-    if (low_bound + cut_weight > min_cut_weight) {
+    if (low_bound + cut_weight > limit) {
+        return;
+    }
+
+    // Small subtrees are enumerated at once instead of recursing node by node
+    if (n - node <= TAIL_SIZE) {
+        tail(node, x_count, cut_weight, partition);
         return;
     }
 
+    // Below the estimated cutoff depth the subtree is searched in place without creating tasks
+    if (node >= task_depth) {
+        if (x_count < a) {
+            partition[node] = 0;
+            dfs(node + 1, x_count + 1, cut_weight + delta_y, partition);
+        }
+        partition[node] = 1;
+        dfs(node + 1, x_count, cut_weight + delta_x, partition);
+        return;
+    }
+
+    // Every task searches its own copy of the partition, taken from the pool of the creating thread and
+    // returned to the pool of the thread that ran it
+    CPartitionPool &pool = pools[omp_get_thread_num()];
+
     // Try adding the node to subset X if it doesn't exceed the allowed size
     if (x_count < a) {
         partition[node] = 0;
-        #pragma omp task firstprivate(partition)
-        dfs(node + 1, x_count + 1, cut_weight + delta_y, partition);
+        vector<int> *copy = pool.acquire();
+        *copy = partition;
+        #pragma omp task firstprivate(copy)
+        {
+            dfs(node + 1, x_count + 1, cut_weight + delta_y, *copy);
+            pools[omp_get_thread_num()].release(copy);
+        }
     }
 
     partition[node] = 1; // Assign the node to subset Y and continue the search
-    #pragma omp task if (node <= a) firstprivate(partition)
-    dfs(node + 1, x_count, cut_weight + delta_x, partition);
+    vector<int> *copy = pool.acquire();
+    *copy = partition;
+    #pragma omp task firstprivate(copy)
+    {
+        dfs(node + 1, x_count, cut_weight + delta_x, *copy);
+        pools[omp_get_thread_num()].release(copy);
+    }
 }
 
-void CSolver::solve() {
+void CSolver::tail(const int node, const int x_count, const int cut_weight, vector<int> &partition) {
+    const int remaining = n - node, x_left = a - x_count;
+    if (x_left < 0 || x_left > remaining)
+        return;
+    const CReplica &replica = replicas[thread_node[omp_get_thread_num()]];
+    const CNodeBound &bound = node_bounds[thread_node[omp_get_thread_num()]];
+
+    // Cost of each unassigned node towards the assigned ones, and the weights among the unassigned nodes
+    int cost_x[TAIL_LANES], cost_y[TAIL_LANES], degree[TAIL_LANES];
+    CTailVector rows[TAIL_LANES] = {};
+    int total = cut_weight; // Cut weight of the current mask, which starts with every unassigned node in Y
+    for (int u = 0; u < remaining; u++) {
+        cost_x[u] = cost_y[u] = degree[u] = 0;
+        for (int j = 0; j < node; j++) {
+            if (partition[j] == 0)
+                cost_y[u] += replica.graph[j][node + u]; // Cut when u goes to Y
+            else
+                cost_x[u] += replica.graph[j][node + u]; // Cut when u goes to X
+        }
+        for (int v = 0; v < remaining; v++) {
+            if (v == u) continue;
+            rows[u][v] = replica.graph[node + u][node + v];
+            degree[u] += rows[u][v];
+        }
+        total += cost_y[u];
+    }
+
+    // Walk all subsets in Gray code order, each step moves one node and updates every lane at once
+    CTailVector in_x = {}; // Weight from each unassigned node to the unassigned nodes in X
+    int mask = 0, count = 0;
+    for (int step = 0; step < 1 << remaining; step++) {
+        if (step > 0) {
+            const int u = __builtin_ctz(step);
+            mask ^= 1 << u;
+            if ((mask >> u) & 1) {
+                total += cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                in_x += rows[u];
+                count++;
+            } else {
+                in_x -= rows[u];
+                total -= cost_x[u] - cost_y[u] + degree[u] - 2 * in_x[u];
+                count--;
+            }
+        }
+        if (count == x_left && total <= bound.min_cut_weight) {
+            for (int u = 0; u < remaining; u++) partition[node + u] = (mask >> u) & 1 ? 0 : 1;
+            record_partition(total, partition);
+        }
+    }
+}
+
+void CSolver::record_partition(const int cut_weight, const vector<int> &partition) {
+    #pragma omp critical
+    {
+        if (cut_weight == min_cut_weight) {
+            best_partitions.push_back(partition); // Store another optimal partition
+        } else if (cut_weight < min_cut_weight) {
+            min_cut_weight = cut_weight; // Update the best cut weight found
+            for (auto &copy: node_bounds) copy.min_cut_weight = cut_weight; // Crosses nodes only here
+            best_partitions.clear(); // Clear previous partitions
+            best_partitions.push_back(partition); // Store the new best partition
+        }
+    }
+}
+
+void CSolver::place_threads() {
+    thread_node.resize(threads);
+    for (int thread = 0; thread < threads; thread++) thread_node[thread] = topology.node_of_thread(thread);
+    replicas.assign(topology.nodes(), CReplica());
+    pools.clear();
+    for (int thread = 0; thread < threads; thread++) pools.emplace_back(n);
+    node_bounds.assign(topology.nodes(), CNodeBound{min_cut_weight});
+}
+
+void CSolver::show_progress() {
+    progress_start = progress_last = chrono::steady_clock::now();
+    progress_nodes = -1; // Turned on once the estimate is known
+}
+
+void CSolver::set_gap(const CGap &gap) {
+    this->gap = gap;
+}
+
+void CSolver::report_progress(const long long calls) {
+    #pragma omp critical (progress)
+    {
+        const auto now = chrono::steady_clock::now();
+        if (now - progress_last >= chrono::seconds(1)) {
+            progress_last = now;
+            const double elapsed = chrono::duration<double>(now - progress_start).count();
+            const double fraction = min(0.99, calls / progress_nodes);
+            cerr << "\rProgress: " << static_cast<int>(100 * fraction) << " %, ETA " << static_cast<int>(
+                elapsed / fraction - elapsed) << " s   " << flush;
+        }
+    }
+}
+
+void CSolver::solve(ostream &out) {
+    // Size the thread team and the task cutoff to the estimated search tree
+    CEstimator estimator(n, a, graph, TAIL_SIZE);
+    estimator.run(ESTIMATE_PROBES);
+    threads = estimator.threads(omp_get_max_threads());
+    task_depth = estimator.task_depth(threads);
+    if (progress_nodes < 0) progress_nodes = estimator.get_nodes();
+
+    place_threads();
+
+    // The calling thread joins the team and gets pinned too, the server keeps using it after the search
+    const cpu_set_t affinity = CTopology::get_affinity();
     vector<int> partition(n, -1); // Partition of the nodes
-    #pragma omp parallel num_threads(omp_get_max_threads())
+    #pragma omp parallel num_threads(threads)
     {
+        // Pin the thread, then let the first thread on each node copy the graph so the pages are allocated there
+        const int thread = omp_get_thread_num();
+        topology.pin_thread(thread);
+        #pragma omp critical
+        {
+            CReplica &replica = replicas[thread_node[thread]];
+            if (replica.graph.empty()) {
+                replica.graph = graph;
+                replica.sparse = sparse;
+            }
+        }
+        #pragma omp barrier
+
         #pragma omp single
         {
             if (2 * a == n) {
@@ -88,17 +262,27 @@ void CSolver::solve() {
             }
         }
     }
-    print_solution();
+    CTopology::set_affinity(affinity);
+    if (progress_nodes > 0) cerr << endl;
+    print_solution(out);
 }
 
-void CSolver::print_solution() const {
-    cout << "Min Cut weight: " << min_cut_weight << endl;
-    for (const auto &it: best_partitions) {
-        cout << "X: ";
-        for (int j = 0; j < n; j++) if (it[j] == 0) cout << j << " ";
-        cout << endl << "Y: ";
-        for (int j = 0; j < n; j++) if (it[j] == 1) cout << j << " ";
-        cout << endl;
+void CSolver::print_solution(ostream &out) const {
+    out << "Min Cut weight: " << min_cut_weight << endl;
+    if (!gap.is_exact()) out << "Guaranteed ratio: " << gap.ratio(min_cut_weight) << endl;
+    for (size_t i = 0; i < best_partitions.get_count(); i++) {
+        const int *it = best_partitions[i];
+        out << "X: ";
+        for (int j = 0; j < n; j++) if (it[j] == 0) out << j << " ";
+        out << endl << "Y: ";
+        for (int j = 0; j < n; j++) if (it[j] == 1) out << j << " ";
+        out << endl;
+    }
+    out << "Recursion: " << n_rec << endl;
+    long long allocations = best_partitions.get_allocations(), reuses = 0;
+    for (const auto &pool: pools) {
+        allocations += pool.get_allocations();
+        reuses += pool.get_reuses();
     }
-    cout << "Recursion: " << n_rec << endl;
+    out << "Allocations: " << allocations << " (" << reuses << " buffers reused)" << endl;
 }
@@ -1,21 +1,69 @@
 #pragma once
 #include <vector>
+#include <ostream>
+#include <chrono>
+#include "CFileReader.h"
+#include "CTopology.h"
+#include "CGap.h"
+#include "CArena.h"
 
 using namespace std;
 
+constexpr double SPARSE_DENSITY = 0.75; // Graphs below this density use the sparse kernels in dfs
+constexpr int TAIL_SIZE = 10; // Subtrees with at most this many unassigned nodes are enumerated by the tail kernel
+constexpr int TAIL_LANES = 16; // Vector width of the tail kernel, at least TAIL_SIZE
+
+typedef int CTailVector __attribute__((vector_size(4 * TAIL_LANES))); // One lane per unassigned node
+
+struct CReplica {
+    vector<vector<int> > graph; // Dense matrix allocated on one NUMA node
+    CSparseGraph sparse; // Neighbour lists allocated on the same node
+};
+
+struct alignas(64) CNodeBound {
+    int min_cut_weight; // Copy of the best cut weight read by the threads of one NUMA node
+};
+
 class CSolver {
     const int n, a;
     const vector<vector<int> > graph;
+    const CSparseGraph sparse; // Same graph as neighbour lists
+    const bool use_sparse; // Iterate only over real neighbours in dfs
 
     int min_cut_weight; // Weight of the minimum cut
-    vector<vector<int> > best_partitions; // Best solutions
+    CGap gap; // Allowed distance from the optimum, exact by default
+    CPartitionArena best_partitions; // Best solutions
+    long long n_rec; // Number of recursions
+
+    int threads; // Threads worth starting for this instance
+    int task_depth; // Both branches become tasks above this depth, deeper subtrees are searched in place
+    double progress_nodes; // Estimated size of the search tree, 0 to hide the progress indicator
+    chrono::time_point<chrono::steady_clock> progress_start, progress_last;
+
+    const CTopology topology; // NUMA nodes and CPUs the threads are pinned to
+    vector<int> thread_node; // NUMA node of each thread
+    vector<CReplica> replicas; // Graph copies, one per NUMA node
+    vector<CNodeBound> node_bounds; // Best cut weight, one copy per NUMA node
+    vector<CPartitionPool> pools; // Partition copies of the tasks, one pool per thread
+
+    void place_threads();
+
+    void report_progress(long long calls);
 
 public:
-    CSolver(int n, int a, const vector<vector<int> > &graph);
+    CSolver(int n, int a, const vector<vector<int> > &graph, const CSparseGraph &sparse);
 
     void dfs(int node, int x_count, int cut_weight, vector<int> &partition);
 
-    void solve();
+    void tail(int node, int x_count, int cut_weight, vector<int> &partition);
+
+    void record_partition(int cut_weight, const vector<int> &partition);
+
+    void show_progress();
+
+    void set_gap(const CGap &gap);
+
+    void solve(ostream &out);
 
-    void print_solution() const;
+    void print_solution(ostream &out) const;
 };
@@ -0,0 +1,113 @@
+#include "CTopology.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sched.h>
+#ifdef USE_LIBNUMA
+#include <numa.h>
+#endif
+
+CTopology::CTopology() : pinning(true) {
+    const char *pin = getenv("MINCUT_PIN");
+    if (pin != nullptr && strcmp(pin, "0") == 0) pinning = false;
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+#ifdef USE_LIBNUMA
+    if (numa_available() != -1) {
+        bitmask *mask = numa_allocate_cpumask();
+        for (int node = 0; node <= numa_max_node(); node++) {
+            if (numa_node_to_cpus(node, mask) != 0) continue;
+            vector<int> node_list;
+            for (int cpu = 0; cpu < static_cast<int>(mask->size) && cpu < CPU_SETSIZE; cpu++)
+                if (numa_bitmask_isbitset(mask, cpu) && CPU_ISSET(cpu, &allowed)) node_list.push_back(cpu);
+            if (!node_list.empty()) node_cpus.push_back(node_list);
+        }
+        numa_free_cpumask(mask);
+    }
+#else
+    // Without libnuma read the node layout from sysfs, which every Linux kernel with NUMA support provides
+    for (int node = 0;; node++) {
+        ifstream file("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+        if (!file.is_open()) break;
+        string line;
+        getline(file, line);
+        vector<int> node_list;
+        for (const int cpu: parse_cpu_list(line.c_str()))
+            if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) node_list.push_back(cpu);
+        if (!node_list.empty()) node_cpus.push_back(node_list);
+    }
+#endif
+
+    // Single node fallback with every allowed CPU
+    if (node_cpus.empty()) {
+        node_cpus.emplace_back();
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            if (CPU_ISSET(cpu, &allowed)) node_cpus.back().push_back(cpu);
+    }
+
+    // Unpinned threads may run anywhere, so per-node data would not stay local
+    if (!pinning) {
+        vector<int> all;
+        for (const auto &node_list: node_cpus) all.insert(all.end(), node_list.begin(), node_list.end());
+        node_cpus.assign(1, all);
+    }
+
+    for (int node = 0; node < static_cast<int>(node_cpus.size()); node++) {
+        for (const int cpu: node_cpus[node]) {
+            cpus.push_back(cpu);
+            cpu_node.push_back(node);
+        }
+    }
+}
+
+vector<int> CTopology::parse_cpu_list(const char *list) {
+    vector<int> result; // Format like "0-3,8-11"
+    while (*list) {
+        char *end;
+        const long first = strtol(list, &end, 10);
+        if (end == list) break;
+        long last = first;
+        list = end;
+        if (*list == '-') {
+            last = strtol(list + 1, &end, 10);
+            list = end;
+        }
+        for (long cpu = first; cpu <= last; cpu++) result.push_back(static_cast<int>(cpu));
+        if (*list == ',') list++;
+        else break;
+    }
+    return result;
+}
+
+int CTopology::nodes() const {
+    return static_cast<int>(node_cpus.size());
+}
+
+int CTopology::node_of_thread(const int thread) const {
+    // Threads fill the CPUs in node order, so consecutive threads share a node
+    return cpu_node[thread % cpus.size()];
+}
+
+void CTopology::pin_thread(const int thread) const {
+    if (!pinning) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[thread % cpus.size()], &set);
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+cpu_set_t CTopology::get_affinity() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    sched_getaffinity(0, sizeof(set), &set);
+    return set;
+}
+
+void CTopology::set_affinity(const cpu_set_t &set) {
+    sched_setaffinity(0, sizeof(set), &set);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include <sched.h>
+
+using namespace std;
+
+class CTopology {
+    vector<vector<int> > node_cpus; // CPUs of each NUMA node usable by this process
+    vector<int> cpus; // All usable CPUs, grouped by NUMA node
+    vector<int> cpu_node; // NUMA node of each entry in cpus
+    bool pinning; // Threads are bound to CPUs (disabled with MINCUT_PIN=0)
+
+    static vector<int> parse_cpu_list(const char *list);
+
+public:
+    CTopology();
+
+    int nodes() const;
+
+    int node_of_thread(int thread) const;
+
+    void pin_thread(int thread) const;
+
+    static cpu_set_t get_affinity();
+
+    static void set_affinity(const cpu_set_t &set);
+};
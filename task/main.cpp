@@ -1,16 +1,41 @@
 #include <iostream>
 #include <vector>
 #include <chrono>
+#include <omp.h>
 
 #include "CFileReader.h"
 #include "CSolver.h"
+#include "CServer.h"
+#include "CPortfolio.h"
+#include "CGap.h"
 
 using namespace std;
 using namespace chrono;
 
 int main(const int argc, char *argv[]) {
-    if (argc != 3) {
-        cerr << "<Size of set X = 'a'> <input_file>" << endl;
+    // Server mode keeps the thread pool running and answers requests on a Unix domain socket
+    if ((argc == 3 || argc == 4) && string(argv[1]) == "--server") {
+        CServer server(argv[2], argc == 4 ? argv[3] : "");
+        return server.run() ? 0 : 1;
+    }
+
+    // Optional mode and the cut weight or percentage the result may be above the optimum
+    string option;
+    CGap gap;
+    bool valid = argc >= 3;
+    for (int i = 3; i < argc && valid; i++) {
+        const string arg = argv[i];
+        if (arg == "--gap" && i + 1 < argc) {
+            if (!gap.parse(argv[++i])) return 1;
+        } else if ((arg == "--progress" || arg == "--portfolio") && option.empty()) {
+            option = arg;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid) {
+        cerr << "<Size of set X = 'a'> <input_file> [--progress | --portfolio] [--gap <weight | percent%>]" << endl;
+        cerr << "--server <socket_path> [<cache_dir>]" << endl;
         return 1;
     }
 
@@ -27,13 +52,24 @@ int main(const int argc, char *argv[]) {
     // Read the graph from the input file
     int n;
     vector<vector<int> > graph;
-    if (!file_reader.readFromFile(argv[2], graph, n)) {
+    CSparseGraph sparse;
+    if (!file_reader.readFromFile(argv[2], graph, sparse, n)) {
         return 1;
     }
 
-    // Solve the problem
-    CSolver solver(n, a, graph);
-    solver.solve();
+    // Solve the problem, either by one search shared by all threads or by racing one strategy per thread
+    if (option == "--portfolio") {
+        CPortfolio portfolio(n, a, graph, omp_get_max_threads());
+        portfolio.set_gap(gap);
+        portfolio.solve(cout);
+    } else {
+        CSolver solver(n, a, graph, sparse);
+        solver.set_gap(gap);
+        if (option == "--progress") {
+            solver.show_progress();
+        }
+        solver.solve(cout);
+    }
 
     // Measure and display execution time
     const auto end_time = high_resolution_clock::now();